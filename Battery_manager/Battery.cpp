@@ -225,10 +225,15 @@ void Battery::set_battery_status_right(uint8_t battery_status)
 }
 
 void Battery::run()
+{
+    /* The timeouts are handled by the callbacks of the side timers */
+}
+
+void Battery::disconnect_grace_timeout_cb( void * p_side )
 {
     // Confirm pending DISCONNECTED only after grace period
 
-    if (left.disconnect_pending && ( left.disconnect_grace_started_timer_check() == true ))
+    if (p_side == &left)
     {
         status_left = 4;
         left.cancelDisconnect();
@@ -237,7 +242,7 @@ void Battery::run()
 #endif
     }
 
-    if (right.disconnect_pending && ( right.disconnect_grace_started_timer_check() == true ))
+    if (p_side == &right)
     {
         status_right = 4;
         right.cancelDisconnect();
@@ -245,8 +250,11 @@ void Battery::run()
         NRF_LOG_DEBUG("Battery RIGHT: disconnect grace elapsed -> status 4");
 #endif
     }
+}
 
-    if(left.status_requested && (left.last_status_packet_timer_check() == true))
+void Battery::last_status_packet_timeout_cb( void * p_side )
+{
+    if (p_side == &left && left.status_requested)
     {
         left.last_status_packet_timer_reset();
 
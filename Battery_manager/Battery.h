@@ -55,30 +55,20 @@ class Battery {
         uint8_t status_confirm_count;
 
         // Debounce for DISCONNECTED (status 4)
-        dl_timer_t disconnect_grace_started_timer;
+        dl_sw_timer_t disconnect_grace_started_timer;
         bool disconnect_pending;
 
-        dl_timer_t last_status_packet_timer;
+        dl_sw_timer_t last_status_packet_timer;
         bool status_requested;
 
         void disconnect_grace_started_timer_reset()
         {
-            timer_set_ms( &disconnect_grace_started_timer, DISCONNECT_GRACE_TIMEOUT_MS );
-        }
-
-        bool disconnect_grace_started_timer_check()
-        {
-            return timer_check( &disconnect_grace_started_timer );
+            timer_start( &disconnect_grace_started_timer, DISCONNECT_GRACE_TIMEOUT_MS, disconnect_grace_timeout_cb, this );
         }
 
         void last_status_packet_timer_reset()
         {
-            timer_set_ms( &last_status_packet_timer, LAST_STATUS_PACKET_TIMEOUT_MS );
-        }
-
-        bool last_status_packet_timer_check()
-        {
-            return timer_check( &last_status_packet_timer );
+            timer_start( &last_status_packet_timer, LAST_STATUS_PACKET_TIMEOUT_MS, last_status_packet_timeout_cb, this );
         }
 
         void reset()
@@ -97,6 +87,7 @@ class Battery {
         void cancelDisconnect()
         {
             disconnect_pending = false;
+            timer_stop( &disconnect_grace_started_timer );
         }
 
         void requestStatus()
@@ -122,6 +113,9 @@ class Battery {
     static bat_status_side_t right;
     static bat_status_side_t left; 
 
+    static void disconnect_grace_timeout_cb( void * p_side );
+    static void last_status_packet_timeout_cb( void * p_side );
+
     static const kbdif_handlers_t kbdif_handlers;
 
     static kbdapi_event_result_t kbdif_key_event_cb( void * p_instance, kbdapi_key_t * p_key );
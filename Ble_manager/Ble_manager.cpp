@@ -28,6 +28,7 @@
 
 #include "Do_once.h"
 #include "kbd_if_manager.h"
+#include "nrf_sdh_ble.h"
 
 void device_name_evt_handler(void);
 
@@ -35,6 +36,10 @@ void device_name_evt_handler(void);
 
 #define KEY_ERASE_HOLD_TIMEOUT_MS   3000
 
+#ifndef BLE_MANAGER_BLE_OBSERVER_PRIO
+#define BLE_MANAGER_BLE_OBSERVER_PRIO   3   /* After the stack modules, which update the states checked by the run */
+#endif
+
 Do_once clear_pin_digits_count;
 
 
@@ -46,6 +51,9 @@ result_t BleManager::init()
     result = kbdif_initialize();
     EXIT_IF_ERR( result, "kbdif_initialize failed" );
 
+    result = sched_task_initialize();
+    EXIT_IF_ERR( result, "sched_task_initialize failed" );
+
     result = kbdapi_key_report_lock_init( &kbdapi_key_report_lock );
     EXIT_IF_ERR( result, "kbdapi_key_report_lock_init failed" );
 
@@ -172,6 +180,8 @@ void BleManager::enable(void)
             cfgmem_connection_reset( &paired_device );
         }
     }
+
+    run_request();
 }
 
 void BleManager::update_channel_and_name(void)
@@ -223,23 +233,20 @@ void BleManager::timer_save_conn_run(uint32_t timeout_ms)
 #if BLE_MANAGER_DEBUG_LOG
         NRF_LOG_DEBUG("Ble_manager: Start timer save connection.");
 #endif
-        timer_set_ms( &timer_save_new_conn, timeout_ms );
-        timer_save_conn_start_count = true;
+        timer_start( &timer_save_new_conn, timeout_ms, timer_save_conn_cb, this );
     }
 
-    if (timer_save_conn_start_count)
-    {
-        if ( timer_check(&timer_save_new_conn) == true )
-        {
+    // While this timer is running, the periodic update timer remains reset.
+}
+
+void BleManager::timer_save_conn_cb(void * p_instance)
+{
+    BleManager * p_BleManager = ( BleManager *)p_instance;
+
 #if BLE_MANAGER_DEBUG_LOG
-            NRF_LOG_DEBUG("Ble_manager: Timeout timer save connection.");
+    NRF_LOG_DEBUG("Ble_manager: Timeout timer save connection.");
 #endif
-            save_connection();
-            timer_save_conn_start_count = false;
-        }
-
-        // While this timer is running, the periodic update timer remains reset.
-    }
+    p_BleManager->save_connection();
 }
 
 void BleManager::save_connection(void)
@@ -294,23 +301,20 @@ void BleManager::timer_save_name_run(uint32_t timeout_ms)
 #if BLE_MANAGER_DEBUG_LOG
         NRF_LOG_DEBUG("Ble_manager: Start timer save name.");
 #endif
-        timer_set_ms( &timer_save_new_name, timeout_ms );
-        timer_save_name_start_count = true;
+        timer_start( &timer_save_new_name, timeout_ms, timer_save_name_cb, this );
     }
 
-    if (timer_save_name_start_count)
-    {
-        if ( timer_check(&timer_save_new_name) == true )
-        {
+    // While this timer is running, the periodic update timer remains reset.
+}
+
+void BleManager::timer_save_name_cb(void * p_instance)
+{
+    BleManager * p_BleManager = ( BleManager *)p_instance;
+
 #if BLE_MANAGER_DEBUG_LOG
-            NRF_LOG_DEBUG("Ble_manager: Timeout timer save name.");
+    NRF_LOG_DEBUG("Ble_manager: Timeout timer save name.");
 #endif
-            save_device_name();
-            timer_save_name_start_count = false;
-        }
-
-        // While this timer is running, the periodic update timer remains reset.
-    }
+    p_BleManager->save_device_name();
 }
 
 void BleManager::save_device_name(void)
@@ -562,6 +566,15 @@ void BleManager::run()
         mitm_activated = false;
     }
 
+    // A configuration restore can not go on without its host
+    static bool connected_prev = false;
+
+    if (connected_prev && !ble_connected())
+    {
+        ConfigManager.restore_abort();
+    }
+    connected_prev = ble_connected();
+
     // Gives time to the EPPROM to update
     static bool activated_advertising = false;
 
@@ -615,6 +628,49 @@ void BleManager::run()
     }
 }
 
+result_t BleManager::sched_task_initialize()
+{
+    sched_task_conf_t config;
+
+    /* Prepare the scheduler task configuration */
+    config.p_name = "ble";
+    config.p_instance = this;
+    config.run = sched_task_run_cb;
+
+    config.prio = SCHED_PRIO_NORMAL;
+    config.poll = false;            /* Made ready by the softdevice events and the key events */
+    config.wake = false;
+    config.budget_us = 500;
+
+    return sched_task_add( &p_sched_task, &config );
+}
+
+void BleManager::run_request(void)
+{
+    if (p_sched_task != NULL)
+    {
+        sched_task_ready( p_sched_task );
+    }
+}
+
+static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    UNUSED( p_ble_evt );
+    UNUSED( p_context );
+
+    /* The BLE flags and states checked by the run are set by the softdevice handlers */
+    BleManager.run_request();
+}
+
+NRF_SDH_BLE_OBSERVER( ble_manager_ble_observer, BLE_MANAGER_BLE_OBSERVER_PRIO, ble_evt_handler, NULL );
+
+void BleManager::sched_task_run_cb(void * p_instance)
+{
+    BleManager * p_ble_manager = (BleManager *)p_instance;
+
+    p_ble_manager->run();
+}
+
 result_t BleManager::kbdif_initialize()
 {
     result_t result = RESULT_ERR;
@@ -865,6 +921,9 @@ kbdapi_event_result_t BleManager::kbdif_key_event_cb( void * p_instance, kbdapi_
 {
     BleManager * p_BleManager = ( BleManager *)p_instance;
 
+    /* The key handling changes the pairing and the LED states checked by the run */
+    p_BleManager->run_request();
+
     return p_BleManager->kbdif_key_event_process( p_key );
 }
 
@@ -1044,4 +1103,5 @@ void device_name_evt_handler(void)
 #endif
 
     BleManager.trigger_save_name_timer = true;
+    BleManager.run_request();
 }
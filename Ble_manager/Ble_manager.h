@@ -66,6 +66,7 @@ class BleManager
     void send_led_mode(void);
 
     void run();
+    void run_request(void);     /* The run goes in the next scheduler pass. Can be called from the interrupts */
 
   private:
 
@@ -114,22 +115,27 @@ class BleManager
     char encryption_pin_number[6] = {};
 
     bool trigger_save_conn_timer = false;
-    bool timer_save_conn_start_count = false;
-    dl_timer_t timer_save_new_conn = 0;
+    dl_sw_timer_t timer_save_new_conn = {};
 
-    bool timer_save_name_start_count = false;
-    dl_timer_t timer_save_new_name = 0;
+    dl_sw_timer_t timer_save_new_name = {};
 
     kbdif_t * p_kbdif = NULL;
     kbdapi_key_report_lock_t kbdapi_key_report_lock;
 
     result_t kbdif_initialize(void);
+
+    sched_task_t * p_sched_task = NULL;
+    result_t sched_task_initialize(void);
+    static void sched_task_run_cb(void * p_instance);
+
     kbdapi_event_result_t kbdif_key_event_process( kbdapi_key_t * p_key );
 
     void timer_save_conn_run(uint32_t timeout_ms);
+    static void timer_save_conn_cb(void * p_instance);
     void save_connection(void);
 
     void timer_save_name_run(uint32_t timeout_ms);
+    static void timer_save_name_cb(void * p_instance);
     void save_device_name(void);
 
     void set_paired_channel_led(uint8_t channel, bool turnOn);
@@ -19,6 +19,11 @@
 
 #include "Config_manager.h"
 #include "EEPROM.h"
+#include "EEPROM_ll.h"
+#include "Kaleidoscope-FocusSerial.h"
+
+#include "kbd_if_manager.h"
+#include "MultiReport/RawHID.h"
 
 bool_t ConfigManager::item_validity_check( const void * p_item_add, uint16_t item_size )
 {
@@ -38,11 +43,29 @@ result_t ConfigManager::config_item_request( cfg_item_type_t item_type, const vo
         return RESULT_ERR;
     }
 
+#if CONFIG_MANAGER_XIP_ENABLED
+    result_t result = item_request_cb( item_type, pp_item );
+    if( result == RESULT_OK )
+    {
+        *pp_item = xip_item_translate( *pp_item );
+    }
+
+    return result;
+#else
     return item_request_cb( item_type, pp_item );
+#endif
 }
 
 result_t ConfigManager::config_item_update( const void * p_config_item, const void * p_new_item, uint16_t item_size )
 {
+#if CONFIG_MANAGER_XIP_ENABLED
+    if( xip_item_check( p_config_item, item_size ) == true )
+    {
+        /* The item lives in the flash */
+        return xip_item_update( p_config_item, p_new_item, item_size );
+    }
+#endif
+
     if( item_validity_check( p_config_item, item_size ) == false )
     {
         ASSERT_DYGMA( false, "ConfigManager::item_validity_check failed" );
@@ -77,11 +100,42 @@ void ConfigManager::config_load( void )
 void ConfigManager::config_save_request( void )
 {
     config_save_requested = true;
-    timer_set_ms( &config_save_timer, CONFIG_SAVE_TIMEOUT_MS );
+    timer_start( &config_save_timer, CONFIG_SAVE_TIMEOUT_MS, config_save_timer_cb, this );
+}
+
+void ConfigManager::config_save_timer_cb( void * p_instance )
+{
+    ConfigManager * p_ConfigManager = ( ConfigManager *)p_instance;
+
+    if( p_ConfigManager->restore_active == true )
+    {
+        /* The restore is saved at once by its commit */
+        return;
+    }
+
+    /* The save may have been already done by config_save_now */
+    if( p_ConfigManager->config_save_requested == false )
+    {
+        return;
+    }
+
+    if( p_ConfigManager->machine_state != CONFIG_STATE_IDLE )
+    {
+        /* The previous save is still in progress, try again later */
+        timer_start( &p_ConfigManager->config_save_timer, CONFIG_SAVE_TIMEOUT_MS, config_save_timer_cb, p_ConfigManager );
+        return;
+    }
+
+    p_ConfigManager->config_save_requested = false;
+    p_ConfigManager->machine_state_set( CONFIG_STATE_SAVE );
 }
 
 result_t ConfigManager::config_save( void )
 {
+#if CONFIG_MANAGER_XIP_ENABLED
+    /* Only the modified pages are rewritten */
+    return xip_save( NULL );
+#else
     result_t result = RESULT_ERR;
 
     result = EEPROM.erase();
@@ -92,12 +146,405 @@ result_t ConfigManager::config_save( void )
     ASSERT_DYGMA( result == RESULT_OK, "EEPROM.write failed" );
     EXIT_IF_ERR( result, "EEPROM.write failed" );
 
+    result = EEPROM.commit();
+    ASSERT_DYGMA( result == RESULT_OK, "EEPROM.commit failed" );
+    EXIT_IF_ERR( result, "EEPROM.commit failed" );
+
 _EXIT:
     return result;
+#endif
+}
+
+#if CONFIG_MANAGER_XIP_ENABLED
+/********************************************/
+/*             Execute in place             */
+/********************************************/
+
+#define XIP_SCRATCH_TAG_MAGIC       0x50494358
+
+#define XIP_WB_RECORD_SIZE( len )   ( ( sizeof( xip_wb_record_t ) + (len) + 3 ) & ~3UL )
+#define XIP_WB_RECORD_DATA( p_rec ) ( (uint8_t *)(p_rec) + sizeof( xip_wb_record_t ) )
+
+static INLINE void xip_chunk_patch( uint32_t chunk_offset, uint8_t * p_chunk, uint32_t chunk_len,
+                                    uint32_t item_offset, const uint8_t * p_item_data, uint32_t item_len )
+{
+    uint32_t start = ( chunk_offset > item_offset ) ? chunk_offset : item_offset;
+    uint32_t end = ( chunk_offset + chunk_len < item_offset + item_len ) ? chunk_offset + chunk_len : item_offset + item_len;
+
+    if( start >= end )
+    {
+        /* The item is not within the chunk */
+        return;
+    }
+
+    memcpy( &p_chunk[ start - chunk_offset ], &p_item_data[ start - item_offset ], end - start );
 }
 
+result_t ConfigManager::xip_init( const ConfigManager_config_t * p_config )
+{
+    uint32_t page_size = EEPROM.page_size_get();
+
+    image_size = p_config->config_image_size;
+    if( image_size < cache_size || (image_size % EEPROM.align_get()) != 0 )
+    {
+        ASSERT_DYGMA( false, "Invalid configuration image size" );
+        return RESULT_ERR;
+    }
+
+    /* The last EEPROM page is used as the scratch page, and its tag needs the end of the page. See Config_manager.h */
+    scratch_page = ( EEPROM.size_get() / page_size ) - 1;
+    if( image_size > scratch_page * page_size || image_size > page_size - sizeof( xip_scratch_tag_t ) )
+    {
+        ASSERT_DYGMA( false, "The configuration image does not leave space for the scratch page" );
+        return RESULT_ERR;
+    }
+
+    p_image = EEPROM.ptr_get( 0 );
+    xip_wb_len = 0;
+
+    /* Finish the save interrupted by a reset, if any */
+    return xip_scratch_recover();
+}
+
+INLINE const void * ConfigManager::xip_item_translate( const void * p_item )
+{
+    const uint8_t * p_item_add = (const uint8_t *)p_item;
+
+    if( p_item_add < p_cache || p_item_add >= p_cache + image_size )
+    {
+        /* Out of the image. Leave it for the validity check */
+        return p_item;
+    }
+    else if( p_item_add < p_cache + cache_size )
+    {
+        /* The item is kept in the RAM cache */
+        return p_item;
+    }
+
+    return p_image + ( p_item_add - p_cache );
+}
+
+INLINE bool_t ConfigManager::xip_item_check( const void * p_item_add, uint16_t item_size )
+{
+    /* Check the target is within the part of the image read in place */
+    if( (const uint8_t *)p_item_add < p_image + cache_size || ((const uint8_t *)p_item_add + item_size) > p_image + image_size )
+    {
+        return false;
+    }
+
+    return true;
+}
+
+ConfigManager::xip_wb_record_t * ConfigManager::xip_wb_record_last_get( uint32_t offset, uint32_t len )
+{
+    xip_wb_record_t * p_record_last = NULL;
+    xip_wb_record_t * p_record;
+    uint16_t pos = 0;
+
+    while( pos < xip_wb_len )
+    {
+        p_record = (xip_wb_record_t *)&xip_wb[ pos ];
+
+        if( p_record->offset < offset + len && offset < (uint32_t)p_record->offset + p_record->len )
+        {
+            p_record_last = p_record;
+        }
+
+        pos += XIP_WB_RECORD_SIZE( p_record->len );
+    }
+
+    return p_record_last;
+}
+
+result_t ConfigManager::xip_item_update( const void * p_config_item, const void * p_new_item, uint16_t item_size )
+{
+    result_t result = RESULT_OK;
+    xip_wb_record_t * p_record;
+    xip_item_t item;
+
+    if( restore_active == true )
+    {
+        /* The restore staged in the scratch page replaces the whole image */
+        return RESULT_ERR;
+    }
+
+    item.offset = (const uint8_t *)p_config_item - p_image;
+    item.len = item_size;
+    item.p_data = (const uint8_t *)p_new_item;
+
+    p_record = xip_wb_record_last_get( item.offset, item.len );
+    if( p_record == NULL )
+    {
+        /* There is no pending change of the item, so the flash holds its current value */
+        if( memcmp( p_config_item, p_new_item, item_size ) == 0 )
+        {
+            return RESULT_OK;
+        }
+    }
+    else if( p_record->offset == item.offset && p_record->len == item.len )
+    {
+        /* The item is the last pending change of its space, so it can be updated in place */
+        memcpy( XIP_WB_RECORD_DATA( p_record ), p_new_item, item_size );
+
+        config_save_request();
+
+        return RESULT_OK;
+    }
+
+    if( XIP_WB_RECORD_SIZE( item_size ) > sizeof( xip_wb ) - xip_wb_len )
+    {
+        /* There is no space left in the write-back buffer. Save the item now together with the pending changes */
+        config_save_requested = false;
+
+        result = xip_save( &item );
+        EXIT_IF_ERR( result, "xip_save failed" );
+
+        goto _EXIT;
+    }
+
+    /* Append the change to the write-back buffer, it is written by the delayed config save */
+    p_record = (xip_wb_record_t *)&xip_wb[ xip_wb_len ];
+    p_record->offset = item.offset;
+    p_record->len = item.len;
+    memcpy( XIP_WB_RECORD_DATA( p_record ), p_new_item, item_size );
+
+    xip_wb_len += XIP_WB_RECORD_SIZE( item_size );
+
+    config_save_request();
+
+_EXIT:
+    return result;
+}
+
+void ConfigManager::xip_chunk_compose( uint32_t offset, uint8_t * p_chunk, uint32_t len, const xip_item_t * p_extra )
+{
+    xip_wb_record_t * p_record;
+    uint32_t head_len = 0;
+    uint16_t pos = 0;
+
+    /* The head of the image comes from the RAM cache and the rest from the flash */
+    if( offset < cache_size )
+    {
+        head_len = ( offset + len <= cache_size ) ? len : cache_size - offset;
+    }
+
+    memcpy( p_chunk, &p_cache[ offset ], head_len );
+    memcpy( &p_chunk[ head_len ], &p_image[ offset + head_len ], len - head_len );
+
+    /* Apply the pending changes in the same order they were done */
+    while( pos < xip_wb_len )
+    {
+        p_record = (xip_wb_record_t *)&xip_wb[ pos ];
+
+        xip_chunk_patch( offset, p_chunk, len, p_record->offset, XIP_WB_RECORD_DATA( p_record ), p_record->len );
+
+        pos += XIP_WB_RECORD_SIZE( p_record->len );
+    }
+
+    if( p_extra != NULL )
+    {
+        xip_chunk_patch( offset, p_chunk, len, p_extra->offset, p_extra->p_data, p_extra->len );
+    }
+}
+
+bool_t ConfigManager::xip_page_dirty_check( uint32_t page, const xip_item_t * p_extra )
+{
+    uint32_t page_size = EEPROM.page_size_get();
+    uint32_t start = page * page_size;
+    uint32_t end = ( start + page_size < image_size ) ? start + page_size : image_size;
+    uint32_t head_end;
+
+    /* Changes in the RAM cache */
+    if( start < cache_size )
+    {
+        head_end = ( end < cache_size ) ? end : cache_size;
+
+        if( memcmp( &p_cache[ start ], &p_image[ start ], head_end - start ) != 0 )
+        {
+            return true;
+        }
+    }
+
+    /* Pending changes of the items in the flash */
+    if( xip_wb_record_last_get( start, end - start ) != NULL )
+    {
+        return true;
+    }
+
+    if( p_extra != NULL && p_extra->offset < end && start < p_extra->offset + p_extra->len )
+    {
+        return true;
+    }
+
+    return false;
+}
+
+result_t ConfigManager::xip_scratch_tag_write( uint32_t page )
+{
+    uint32_t page_size = EEPROM.page_size_get();
+    xip_scratch_tag_t tag;
+
+    tag.page = page;
+    tag.magic = XIP_SCRATCH_TAG_MAGIC;
+
+    return EEPROM.write( ( scratch_page + 1 ) * page_size - sizeof( tag ), (const uint8_t *)&tag, sizeof( tag ) );
+}
+
+result_t ConfigManager::xip_scratch_copy( uint32_t page )
+{
+    result_t result = RESULT_ERR;
+    uint8_t chunk[ XIP_CHUNK_SIZE ] __attribute__((aligned(4)));
+    uint32_t page_size = EEPROM.page_size_get();
+    uint32_t page_start = page * page_size;
+    uint32_t scratch_start = scratch_page * page_size;
+    uint32_t len = ( image_size - page_start < page_size ) ? image_size - page_start : page_size;
+    uint32_t chunk_len;
+    uint32_t pos;
+
+    /* Move the scratch copy into its place */
+    result = EEPROM.page_erase( page );
+    EXIT_IF_ERR( result, "EEPROM.page_erase failed" );
+
+    for( pos = 0; pos < len; pos += chunk_len )
+    {
+        chunk_len = ( len - pos < XIP_CHUNK_SIZE ) ? len - pos : XIP_CHUNK_SIZE;
+
+        result = EEPROM.read( scratch_start + pos, chunk, chunk_len );
+        EXIT_IF_ERR( result, "EEPROM.read failed" );
+
+        result = EEPROM.write( page_start + pos, chunk, chunk_len );
+        EXIT_IF_ERR( result, "EEPROM.write failed" );
+    }
+
+_EXIT:
+    return result;
+}
+
+result_t ConfigManager::xip_scratch_recover( void )
+{
+    result_t result = RESULT_OK;
+    uint32_t page_size = EEPROM.page_size_get();
+    const uint8_t * p_scratch = EEPROM.ptr_get( scratch_page * page_size );
+    const xip_scratch_tag_t * p_tag = (const xip_scratch_tag_t *)( p_scratch + page_size - sizeof( xip_scratch_tag_t ) );
+    uint32_t page_start;
+    uint32_t len;
+
+    /*
+     * Without the tag the reset came while the copy was being composed and the page itself is still intact. With the
+     * tag, the copy is complete and the page matches it unless the reset came while it was being moved.
+     */
+    if( p_tag->magic != XIP_SCRATCH_TAG_MAGIC || p_tag->page >= scratch_page )
+    {
+        return RESULT_OK;
+    }
+
+    page_start = p_tag->page * page_size;
+    len = ( image_size - page_start < page_size ) ? image_size - page_start : page_size;
+
+    if( memcmp( p_image + page_start, p_scratch, len ) != 0 )
+    {
+        result = xip_scratch_copy( p_tag->page );
+        ASSERT_DYGMA( result == RESULT_OK, "xip_scratch_copy failed" );
+    }
+
+    return result;
+}
+
+result_t ConfigManager::xip_scratch_fill( uint32_t start, uint32_t end )
+{
+    result_t result = RESULT_OK;
+    uint8_t chunk[ XIP_CHUNK_SIZE ] __attribute__((aligned(4)));
+    uint32_t scratch_start = scratch_page * EEPROM.page_size_get();
+    uint32_t chunk_len;
+    uint32_t pos;
+
+    /* Copy the current image into the scratch page */
+    for( pos = start; pos < end; pos += chunk_len )
+    {
+        chunk_len = ( end - pos < XIP_CHUNK_SIZE ) ? end - pos : XIP_CHUNK_SIZE;
+
+        xip_chunk_compose( pos, chunk, chunk_len, NULL );
+
+        result = EEPROM.write( scratch_start + pos, chunk, chunk_len );
+        EXIT_IF_ERR( result, "EEPROM.write failed" );
+    }
+
+_EXIT:
+    return result;
+}
+
+result_t ConfigManager::xip_page_save( uint32_t page, const xip_item_t * p_extra )
+{
+    result_t result = RESULT_ERR;
+    uint8_t chunk[ XIP_CHUNK_SIZE ] __attribute__((aligned(4)));
+    uint32_t page_size = EEPROM.page_size_get();
+    uint32_t page_start = page * page_size;
+    uint32_t scratch_start = scratch_page * page_size;
+    uint32_t len = ( image_size - page_start < page_size ) ? image_size - page_start : page_size;
+    uint32_t chunk_len;
+    uint32_t pos;
+
+    /* Compose the new page content in the scratch page */
+    result = EEPROM.page_erase( scratch_page );
+    EXIT_IF_ERR( result, "EEPROM.page_erase failed" );
+
+    for( pos = 0; pos < len; pos += chunk_len )
+    {
+        chunk_len = ( len - pos < XIP_CHUNK_SIZE ) ? len - pos : XIP_CHUNK_SIZE;
+
+        xip_chunk_compose( page_start + pos, chunk, chunk_len, p_extra );
+
+        result = EEPROM.write( scratch_start + pos, chunk, chunk_len );
+        EXIT_IF_ERR( result, "EEPROM.write failed" );
+    }
+
+    /* From now on a reset does not lose the save, the copy is moved by the next init */
+    result = xip_scratch_tag_write( page );
+    EXIT_IF_ERR( result, "xip_scratch_tag_write failed" );
+
+    result = xip_scratch_copy( page );
+    EXIT_IF_ERR( result, "xip_scratch_copy failed" );
+
+_EXIT:
+    return result;
+}
+
+result_t ConfigManager::xip_save( const xip_item_t * p_extra )
+{
+    result_t result = RESULT_OK;
+    uint32_t page_size = EEPROM.page_size_get();
+    uint32_t pages_count = ( image_size + page_size - 1 ) / page_size;
+    uint32_t page;
+
+    for( page = 0; page < pages_count; page++ )
+    {
+        if( xip_page_dirty_check( page, p_extra ) == false )
+        {
+            /* Nothing changed in this page, so its erase cycle is saved */
+            continue;
+        }
+
+        result = xip_page_save( page, p_extra );
+        ASSERT_DYGMA( result == RESULT_OK, "xip_page_save failed" );
+        EXIT_IF_ERR( result, "xip_page_save failed" );
+    }
+
+    /* All the pending changes are in the flash now */
+    xip_wb_len = 0;
+
+_EXIT:
+    return result;
+}
+#endif
+
 void ConfigManager::config_save_now( void )
 {
+    if( restore_active == true )
+    {
+        /* The restore is saved at once by its commit */
+        return;
+    }
+
     /* First, let the config machine finish its last operation */
     while( machine_state != CONFIG_STATE_IDLE )
     {
@@ -117,6 +564,441 @@ void ConfigManager::config_save_now( void )
     config_save();
 }
 
+/********************************************/
+/*          Snapshot and restore            */
+/********************************************/
+
+#define SNAPSHOT_CHUNK_SIZE     64
+
+/*
+ * The binary restore is carried by the raw HID only, since its length framed reports ( RAW_HID_RX_FRAME_MARKER ) are
+ * the binary safe transport. Each chunk comes in the same framed report as its command line and a report is stored
+ * entirely or not at all, so the whole chunk is already received when the command is handled and it is never waited
+ * for. The staged restore keeps its state between the chunks, as for the text restore.
+ */
+static void restore_binary_line_end_skip( void )
+{
+    if( RawHID.peek() == '\r' )
+    {
+        RawHID.read();
+    }
+
+    if( RawHID.peek() == '\n' )
+    {
+        RawHID.read();
+    }
+}
+
+uint16_t ConfigManager::image_size_get( void )
+{
+#if CONFIG_MANAGER_XIP_ENABLED
+    return image_size;
+#else
+    return cache_size;
+#endif
+}
+
+result_t ConfigManager::snapshot_read( uint16_t offset, uint8_t * p_data, uint16_t len )
+{
+    if( (uint32_t)offset + len > image_size_get() )
+    {
+        return RESULT_ERR;
+    }
+
+#if CONFIG_MANAGER_XIP_ENABLED
+    /* Including the changes of the RAM cache not saved yet */
+    xip_chunk_compose( offset, p_data, len, NULL );
+#else
+    memcpy( p_data, &p_cache[ offset ], len );
+#endif
+
+    return RESULT_OK;
+}
+
+result_t ConfigManager::restore_write( uint16_t offset, const uint8_t * p_data, uint16_t len )
+{
+    result_t result = RESULT_ERR;
+
+    if( (uint32_t)offset + len > image_size_get() )
+    {
+        goto _EXIT;
+    }
+
+#if CONFIG_MANAGER_XIP_ENABLED
+    if( (offset % EEPROM.align_get()) != 0 || (len % EEPROM.align_get()) != 0 )
+    {
+        /* The chunks are written into the flash as they come */
+        goto _EXIT;
+    }
+#endif
+
+    if( restore_active == false )
+    {
+        /* Persist the pending changes first, so an abort returns to the current configuration */
+        config_save_now();
+
+#if CONFIG_MANAGER_XIP_ENABLED
+        /* Stage the restore in the scratch page, keeping the image before the first chunk */
+        result = EEPROM.page_erase( scratch_page );
+        EXIT_IF_ERR( result, "EEPROM.page_erase failed" );
+
+        result = xip_scratch_fill( 0, offset );
+        EXIT_IF_ERR( result, "xip_scratch_fill failed" );
+#endif
+
+        restore_active = true;
+        restore_offset_next = offset;
+        restore_crc32 = 0;
+    }
+    else if( offset != restore_offset_next )
+    {
+        /* A chunk is missing */
+        result = RESULT_ERR;
+        goto _EXIT;
+    }
+
+#if CONFIG_MANAGER_XIP_ENABLED
+    result = EEPROM.write( scratch_page * EEPROM.page_size_get() + offset, p_data, len );
+    EXIT_IF_ERR( result, "EEPROM.write failed" );
+#else
+    memcpy( &p_cache[ offset ], p_data, len );
+    result = RESULT_OK;
+#endif
+
+    restore_crc32 = dlcrc32_calculate_data( ~restore_crc32, p_data, len );
+    restore_offset_next += len;
+
+    /* The host is still there */
+    timer_start( &restore_timer, CONFIG_RESTORE_TIMEOUT_MS, restore_timer_cb, this );
+
+_EXIT:
+    if( result != RESULT_OK )
+    {
+        /* The restore can not go on, so the commit is going to fail */
+        restore_abort();
+    }
+
+    return result;
+}
+
+result_t ConfigManager::restore_commit( uint32_t crc32 )
+{
+    result_t result = RESULT_ERR;
+
+    if( restore_active == false )
+    {
+        return RESULT_ERR;
+    }
+
+    if( crc32 != restore_crc32 )
+    {
+        goto _EXIT;
+    }
+
+    timer_stop( &restore_timer );
+
+#if CONFIG_MANAGER_XIP_ENABLED
+    /* Complete the staged image with the rest of the current one and move it into its place */
+    result = xip_scratch_fill( restore_offset_next, image_size );
+    EXIT_IF_ERR( result, "xip_scratch_fill failed" );
+
+    result = xip_scratch_tag_write( 0 );
+    EXIT_IF_ERR( result, "xip_scratch_tag_write failed" );
+
+    result = xip_scratch_copy( 0 );
+    EXIT_IF_ERR( result, "xip_scratch_copy failed" );
+
+    restore_active = false;
+
+    /* The RAM cached head comes from the new image */
+    config_save_requested = false;
+    config_load();
+#else
+    restore_active = false;
+
+    /* The single save of the whole restore */
+    config_save_requested = true;
+    config_save_now();
+
+    result = RESULT_OK;
+#endif
+
+_EXIT:
+    if( result != RESULT_OK )
+    {
+        restore_abort();
+    }
+
+    return result;
+}
+
+void ConfigManager::restore_abort( void )
+{
+    if( restore_active == false )
+    {
+        return;
+    }
+
+    restore_active = false;
+    timer_stop( &restore_timer );
+
+#if CONFIG_MANAGER_XIP_ENABLED
+    /* The image has not been touched, the staged copy is left without its tag. Save what the modules changed meanwhile */
+    if( config_save_requested == true )
+    {
+        config_save_request();
+    }
+#else
+    config_save_requested = false;
+
+    /* Return to the saved image */
+    config_load();
+#endif
+}
+
+void ConfigManager::restore_timer_cb( void * p_instance )
+{
+    ConfigManager * p_ConfigManager = ( ConfigManager *)p_instance;
+
+    /* The host has stopped sending, e.g. it got disconnected */
+    p_ConfigManager->restore_abort();
+}
+
+/********************************************/
+/*                  Focus                   */
+/********************************************/
+
+result_t ConfigManager::kbdif_initialize()
+{
+    result_t result = RESULT_ERR;
+    kbdif_conf_t config;
+
+    /* Prepare the kbdif configuration */
+    config.p_instance = this;
+    config.handlers = &kbdif_handlers;
+
+    /* Initialize the kbdif */
+    result = kbdif_init( &p_kbdif, &config );
+    EXIT_IF_ERR( result, "kbdif_init failed" );
+
+    /* Add the kbdif into the kbdif manager */
+    result = kbdifmgr_add( p_kbdif );
+    EXIT_IF_ERR( result, "kbdifmgr_add failed" );
+
+_EXIT:
+    return result;
+}
+
+#if EEPROM_LL_PROF_ENABLED
+#define EEPROM_PROFILE_HELP     "eeprom.profile\neeprom.profile.histogram\neeprom.profile.reset\n"
+#else
+#define EEPROM_PROFILE_HELP     ""
+#endif
+
+kbdapi_event_result_t ConfigManager::kbdif_command_event_cb( void * p_instance, const char * p_command )
+{
+    if (::Focus.handleHelp(p_command, "eeprom.wear\neeprom.wear.pages\n" EEPROM_PROFILE_HELP "eeprom.snapshot\neeprom.restore\neeprom.restore.binary\neeprom.restore.commit"))
+    {
+        return KBDAPI_EVENT_RESULT_IGNORED;
+    }
+
+    if (strncmp(p_command, "eeprom.", 7) != 0)
+    {
+        return KBDAPI_EVENT_RESULT_IGNORED;
+    }
+
+    if (strcmp(p_command + 7, "wear") == 0)
+    {
+        eeprom_wear_t wear;
+
+        /* Pages count, min and max erase count, remaining life in percents and the remaining saves estimation */
+        if ( EEPROM.wear_get( &wear ) == RESULT_OK )
+        {
+            ::Focus.send( wear.pages_count, wear.erase_count_min, wear.erase_count_max, wear.life_remaining, wear.saves_remaining );
+        }
+    }
+    else if (strcmp(p_command + 7, "wear.pages") == 0)
+    {
+        eeprom_wear_t wear;
+
+        if ( EEPROM.wear_get( &wear ) == RESULT_OK )
+        {
+            for ( uint16_t page = 0; page < wear.pages_count; page++ )
+            {
+                ::Focus.send( EEPROM.page_erase_count_get( page ) );
+            }
+        }
+    }
+#if EEPROM_LL_PROF_ENABLED
+    else if (strcmp(p_command + 7, "profile") == 0)
+    {
+        uint32_t stall_total = 0;
+
+        for ( uint8_t op = 0; op < EEPROM_LL_OP_COUNT; op++ )
+        {
+            stall_total += eeprom_ll_prof_get( (eeprom_ll_op_t)op )->stall.total;
+        }
+
+        /* The total stall time and then the read, write and erase stall count, min, avg and max followed by the completion avg and max. All in us */
+        ::Focus.send( stall_total );
+
+        for ( uint8_t op = 0; op < EEPROM_LL_OP_COUNT; op++ )
+        {
+            const eeprom_ll_prof_t * p_prof = eeprom_ll_prof_get( (eeprom_ll_op_t)op );
+
+            ::Focus.send( p_prof->stall.count, p_prof->stall.min, dl_stats_avg_get( &p_prof->stall ), p_prof->stall.max,
+                          dl_stats_avg_get( &p_prof->completion ), p_prof->completion.max );
+        }
+    }
+    else if (strcmp(p_command + 7, "profile.histogram") == 0)
+    {
+        /* The read, write and erase stall histograms */
+        for ( uint8_t op = 0; op < EEPROM_LL_OP_COUNT; op++ )
+        {
+            const eeprom_ll_prof_t * p_prof = eeprom_ll_prof_get( (eeprom_ll_op_t)op );
+
+            for ( uint8_t bucket = 0; bucket < DL_STATS_HIST_BUCKETS; bucket++ )
+            {
+                ::Focus.send( p_prof->stall.hist[ bucket ] );
+            }
+        }
+    }
+    else if (strcmp(p_command + 7, "profile.reset") == 0)
+    {
+        eeprom_ll_prof_reset();
+    }
+#endif
+    else if (strcmp(p_command + 7, "snapshot") == 0)
+    {
+        ConfigManager * p_ConfigManager = ( ConfigManager *)p_instance;
+        uint8_t chunk[ SNAPSHOT_CHUNK_SIZE ];
+        uint32_t crc32 = 0;
+        uint16_t offset = 0;
+        uint16_t len = p_ConfigManager->image_size_get();
+        uint16_t chunk_len;
+        bool_t send_data = false;
+
+        if (!::Focus.isEOL())
+        {
+            /* The range of the image to be sent */
+            ::Focus.read(offset);
+            ::Focus.read(len);
+            send_data = true;
+        }
+
+        if ( (uint32_t)offset + len > p_ConfigManager->image_size_get() )
+        {
+            return KBDAPI_EVENT_RESULT_CONSUMED;
+        }
+
+        /* Without the range only the image size and its CRC32 are sent. The CRC32 is split into the high and low 16 bits */
+        if ( send_data == false )
+        {
+            ::Focus.send( len );
+        }
+
+        for ( ; len > 0; offset += chunk_len, len -= chunk_len )
+        {
+            chunk_len = ( len < sizeof( chunk ) ) ? len : sizeof( chunk );
+
+            p_ConfigManager->snapshot_read( offset, chunk, chunk_len );
+            crc32 = dlcrc32_calculate_data( ~crc32, chunk, chunk_len );
+
+            for ( uint16_t i = 0; i < chunk_len && send_data == true; i++ )
+            {
+                ::Focus.send( chunk[ i ] );
+            }
+        }
+
+        ::Focus.send( (uint16_t)( crc32 >> 16 ), (uint16_t)crc32 );
+    }
+    else if (strcmp(p_command + 7, "restore") == 0)
+    {
+        ConfigManager * p_ConfigManager = ( ConfigManager *)p_instance;
+        uint8_t chunk[ SNAPSHOT_CHUNK_SIZE ];
+        uint16_t offset;
+        uint16_t len;
+        uint16_t chunk_len;
+
+        /* The chunk offset and length followed by its data */
+        ::Focus.read(offset);
+        ::Focus.read(len);
+
+        for ( ; len > 0; offset += chunk_len, len -= chunk_len )
+        {
+            chunk_len = ( len < sizeof( chunk ) ) ? len : sizeof( chunk );
+
+            for ( uint16_t i = 0; i < chunk_len; i++ )
+            {
+                ::Focus.read( chunk[ i ] );
+            }
+
+            if ( p_ConfigManager->restore_write( offset, chunk, chunk_len ) != RESULT_OK )
+            {
+                /* The restore has been aborted, so the commit is going to fail */
+                break;
+            }
+        }
+    }
+    else if (strcmp(p_command + 7, "restore.binary") == 0)
+    {
+        ConfigManager * p_ConfigManager = ( ConfigManager *)p_instance;
+        uint8_t chunk[ SNAPSHOT_CHUNK_SIZE ] __attribute__((aligned(4)));
+        uint16_t offset;
+        uint16_t len;
+
+        /* The chunk offset and length. Its data follows the end of the line, within the same length framed report */
+        ::Focus.read(offset);
+        ::Focus.read(len);
+        restore_binary_line_end_skip();
+
+        if ( len > sizeof( chunk ) || RawHID.available() < len )
+        {
+            /* The chunk does not fit a report. What came of it is dropped, so it is not taken as commands */
+            while ( len > 0 && RawHID.available() > 0 )
+            {
+                len -= RawHID.read( chunk, ( len < sizeof( chunk ) ) ? len : sizeof( chunk ) );
+            }
+
+            p_ConfigManager->restore_abort();
+        }
+        else
+        {
+            RawHID.read( chunk, len );
+
+            /* A failed chunk aborts the restore, so the commit is going to fail */
+            p_ConfigManager->restore_write( offset, chunk, len );
+        }
+    }
+    else if (strcmp(p_command + 7, "restore.commit") == 0)
+    {
+        ConfigManager * p_ConfigManager = ( ConfigManager *)p_instance;
+        uint16_t crc32_high;
+        uint16_t crc32_low;
+        result_t result;
+
+        ::Focus.read(crc32_high);
+        ::Focus.read(crc32_low);
+
+        result = p_ConfigManager->restore_commit( ( (uint32_t)crc32_high << 16 ) | crc32_low );
+
+        ::Focus.send( (uint8_t)( result == RESULT_OK ) );
+    }
+    else
+    {
+        /* Leave the rest of the eeprom commands to their handlers */
+        return KBDAPI_EVENT_RESULT_IGNORED;
+    }
+
+    return KBDAPI_EVENT_RESULT_CONSUMED;
+}
+
+const kbdif_handlers_t ConfigManager::kbdif_handlers =
+{
+    .key_event_cb = NULL,
+    .command_event_cb = kbdif_command_event_cb,
+};
+
 /********************************************/
 /*           Keyboard API memory            */
 /********************************************/
@@ -143,7 +1025,17 @@ INLINE result_t ConfigManager::kbdmem_ll_item_request( kbdmem_item_type_t item_t
         return RESULT_ERR;
     }
 
+#if CONFIG_MANAGER_XIP_ENABLED
+    result_t result = item_request_kbdmem_cb( item_type, pp_item );
+    if( result == RESULT_OK )
+    {
+        *pp_item = xip_item_translate( *pp_item );
+    }
+
+    return result;
+#else
     return item_request_kbdmem_cb( item_type, pp_item );
+#endif
 }
 
 INLINE result_t ConfigManager::kbdmem_ll_data_save( const void * p_mem_target, const void * p_data, uint16_t data_len )
@@ -167,22 +1059,46 @@ result_t ConfigManager::kbdmem_ll_data_save_cb( void * p_instance, const void *
 
 
 /********************************************/
-/*                 Machine                  */
+/*                Scheduler                 */
 /********************************************/
 
-INLINE void ConfigManager::machine_state_set( config_state_t state )
+result_t ConfigManager::sched_task_initialize( void )
 {
-    machine_state = state;
+    sched_task_conf_t config;
+
+    /* Prepare the scheduler task configuration */
+    config.p_name = "config";
+    config.p_instance = this;
+    config.run = sched_task_run_cb;
+
+    config.prio = SCHED_PRIO_LOW;
+    config.poll = false;            /* Made ready by the machine state changes */
+    config.wake = false;
+    config.budget_us = 0;           /* The saves take the flash erase time */
+
+    return sched_task_add( &p_sched_task, &config );
+}
+
+void ConfigManager::sched_task_run_cb( void * p_instance )
+{
+    ConfigManager * p_ConfigManager = ( ConfigManager *)p_instance;
 
-    mcu_sleep_postpone();
+    p_ConfigManager->run();
 }
 
-INLINE void ConfigManager::machine_state_idle( void )
+/********************************************/
+/*                 Machine                  */
+/********************************************/
+
+INLINE void ConfigManager::machine_state_set( config_state_t state )
 {
-    if( config_save_requested == true && timer_check( &config_save_timer ) == true )
+    machine_state = state;
+
+    if( machine_state != CONFIG_STATE_IDLE )
     {
-        config_save_requested = false;
-        machine_state_set( CONFIG_STATE_SAVE );
+        /* The machine has work to do */
+        sched_task_ready( p_sched_task );
+        mcu_wake_event_set( MCU_WAKE_SRC_CONFIG );
     }
 }
 
@@ -206,7 +1122,7 @@ INLINE void ConfigManager::machine( void )
     {
         case CONFIG_STATE_IDLE:
 
-            machine_state_idle();
+            /* The save is started by the config_save_timer callback */
 
             break;
 
@@ -251,12 +1167,24 @@ result_t ConfigManager::init( const ConfigManager_config_t * p_config )
     result = EEPROM.init();
     EXIT_IF_ERR( result, "EEPROM.init failed" );
 
-    /* Get the config image */
+#if CONFIG_MANAGER_XIP_ENABLED
+    /* Map the rest of the image in place */
+    result = xip_init( p_config );
+    EXIT_IF_ERR( result, "xip_init failed" );
+#endif
+
+    /* Get the config image. In the execute in place mode only the RAM cached head is loaded */
     config_load();
 
     /* Initialize the keyboard API memory interface */
     kbdmem_ll_init();
 
+    result = kbdif_initialize();
+    EXIT_IF_ERR( result, "kbdif_initialize failed" );
+
+    result = sched_task_initialize();
+    EXIT_IF_ERR( result, "sched_task_initialize failed" );
+
 _EXIT:
     return result;
 }
@@ -264,6 +1192,12 @@ _EXIT:
 void ConfigManager::run( void )
 {
     machine();
+
+    if( machine_state != CONFIG_STATE_IDLE )
+    {
+        /* The save has failed, retry it in the next pass */
+        sched_task_ready( p_sched_task );
+    }
 }
 
 class ConfigManager ConfigManager;
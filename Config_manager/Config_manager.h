@@ -20,10 +20,41 @@
 #pragma once
 
 #include "dl_middleware.h"
+#include "EEPROM.h"
 #include "Time_counter.h"
 
+#include "kbd_if.h"
 #include "kbd_memory.h"
 
+/*
+ * Execute in place mode. Only the head of the config image ( config_cache_size ) is kept in the RAM cache. The rest of
+ * the image ( up to config_image_size ) is read directly from the memory mapped flash. The items placed there should be
+ * the big ones which are rarely modified ( e.g. palette, colormap ), because their updates are held in a small RAM
+ * write-back buffer and become visible through the flash pointer once the delayed config save ( CONFIG_SAVE_TIMEOUT_MS )
+ * has written them. When the buffer is full, the update is saved at once. The page is composed in a scratch page
+ * first, so a reset in the middle of the save is completed by the next init.
+ *
+ * NOTE: The tag of the scratch copy takes the end of the scratch page, so the whole image ( config_image_size ) must
+ * fit in a single flash page minus 8 bytes. The RAM saved is thus up to one page, less the RAM cached head.
+ */
+#ifndef CONFIG_MANAGER_XIP_ENABLED
+#define CONFIG_MANAGER_XIP_ENABLED      0
+#endif
+
+#ifndef CONFIG_MANAGER_XIP_WB_SIZE
+#define CONFIG_MANAGER_XIP_WB_SIZE      256     /* Size of the RAM write-back buffer for the items modified in the flash */
+#endif
+
+#define XIP_CHUNK_SIZE      128     /* Size of the chunks used to compose the flash pages during the save */
+
+#ifndef CONFIG_RESTORE_TIMEOUT_MS
+#define CONFIG_RESTORE_TIMEOUT_MS       2000    /* The restore is aborted when no chunk comes within this time */
+#endif
+
+#if CONFIG_MANAGER_XIP_ENABLED && FLASH_STORAGE_WL_NUM_PAGES
+#error "The execute in place mode needs the config image at a fixed flash address, which the wear leveling does not keep"
+#endif
+
 class ConfigManager
 {
     public:
@@ -50,6 +81,9 @@ class ConfigManager
         {
             uint8_t * p_config_cache;
             uint16_t config_cache_size;
+#if CONFIG_MANAGER_XIP_ENABLED
+            uint16_t config_image_size;     /* The item request callbacks return the items relative to p_config_cache */
+#endif
 
             /* Callbacks */
             cfg_item_request_cb item_request_cb;
@@ -65,6 +99,22 @@ class ConfigManager
 
         void config_save_now( void );
 
+        /*
+         * Bulk access to the whole configuration image. The restore is written in sequential chunks without any save in
+         * between and it is persisted at once by the commit when the CRC32 of all the chunks matches. Otherwise, or
+         * when the host stops sending for CONFIG_RESTORE_TIMEOUT_MS, the image returns to its last saved state. The
+         * modules read the restored values from their items directly, so the state they derived from the old values
+         * is updated with the next reset.
+         *
+         * In the execute in place mode the restore is staged in the scratch page, so the chunk offsets and lengths must
+         * be aligned ( EEPROM.align_get ) and the image read by the modules only changes with the commit.
+         */
+        uint16_t image_size_get( void );
+        result_t snapshot_read( uint16_t offset, uint8_t * p_data, uint16_t len );
+        result_t restore_write( uint16_t offset, const uint8_t * p_data, uint16_t len );
+        result_t restore_commit( uint32_t crc32 );
+        void restore_abort( void );
+
         void run( void );
 
     private:
@@ -75,12 +125,79 @@ class ConfigManager
         cfg_item_request_cb item_request_cb = nullptr;
         cfg_item_request_kbdmem_cb item_request_kbdmem_cb = nullptr;
 
+        bool_t restore_active = false;
+        uint16_t restore_offset_next;
+        uint32_t restore_crc32;
+        dl_sw_timer_t restore_timer = {};
+        static void restore_timer_cb( void * p_instance );
+
+        kbdif_t * p_kbdif = NULL;
+        result_t kbdif_initialize(void);
+
+        sched_task_t * p_sched_task = NULL;
+        result_t sched_task_initialize(void);
+        static void sched_task_run_cb( void * p_instance );
+
+        static const kbdif_handlers_t kbdif_handlers;
+
+        static kbdapi_event_result_t kbdif_command_event_cb( void * p_instance, const char * p_command );
+
         bool_t item_validity_check( const void * p_item_add, uint16_t item_size );
 
         void config_load( void );
         void config_save_request( void );
         result_t config_save( void );
 
+#if CONFIG_MANAGER_XIP_ENABLED
+        /********************************************/
+        /*             Execute in place             */
+        /********************************************/
+
+    private:
+
+        typedef struct
+        {
+            uint16_t offset;        /* Offset of the item within the config image */
+            uint16_t len;
+        } xip_wb_record_t;          /* The record header is followed by the item data */
+
+        typedef struct
+        {
+            uint32_t offset;        /* Offset of the item within the config image */
+            uint32_t len;
+            const uint8_t * p_data;
+        } xip_item_t;
+
+        typedef struct
+        {
+            uint32_t page;          /* The page the scratch copy belongs to */
+            uint32_t magic;         /* Written last, once the copy is complete */
+        } xip_scratch_tag_t;        /* Placed at the end of the scratch page */
+
+        const uint8_t * p_image;    /* The config image mapped in the flash */
+        uint16_t image_size;
+        uint32_t scratch_page;      /* Used to compose the page being saved before it gets erased */
+
+        uint8_t xip_wb[ CONFIG_MANAGER_XIP_WB_SIZE ] __attribute__((aligned(4)));
+        uint16_t xip_wb_len = 0;
+
+        result_t xip_init( const ConfigManager_config_t * p_config );
+        INLINE const void * xip_item_translate( const void * p_item );
+        INLINE bool_t xip_item_check( const void * p_item_add, uint16_t item_size );
+
+        xip_wb_record_t * xip_wb_record_last_get( uint32_t offset, uint32_t len );
+        result_t xip_item_update( const void * p_config_item, const void * p_new_item, uint16_t item_size );
+
+        void xip_chunk_compose( uint32_t offset, uint8_t * p_chunk, uint32_t len, const xip_item_t * p_extra );
+        bool_t xip_page_dirty_check( uint32_t page, const xip_item_t * p_extra );
+        result_t xip_scratch_tag_write( uint32_t page );
+        result_t xip_scratch_copy( uint32_t page );
+        result_t xip_scratch_recover( void );
+        result_t xip_scratch_fill( uint32_t start, uint32_t end );
+        result_t xip_page_save( uint32_t page, const xip_item_t * p_extra );
+        result_t xip_save( const xip_item_t * p_extra );
+#endif
+
         /********************************************/
         /*           Keyboard API memory            */
         /********************************************/
@@ -109,12 +226,12 @@ class ConfigManager
         } config_state_t;
 
         config_state_t machine_state = CONFIG_STATE_IDLE;
-        dl_timer_t config_save_timer = 0;
+        dl_sw_timer_t config_save_timer = {};
+        static void config_save_timer_cb( void * p_instance );
 
         bool_t config_save_requested = false;
 
         INLINE void machine_state_set( config_state_t state );
-        INLINE void machine_state_idle( void );
         INLINE void machine_state_save( void );
         INLINE void machine( void );
 };
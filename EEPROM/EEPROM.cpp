@@ -27,34 +27,7 @@
 */
 
 #include "EEPROM.h"
-
-#include "Arduino.h"
-
-#ifdef __cplusplus
-extern "C"
-{
-#endif
-
-#include "nrf_fstorage.h"
-
-#ifdef SOFTDEVICE_PRESENT
-#include "nrf_fstorage_sd.h"
-#else
-#include "nrf_fstorage_nvmc.h"
-#endif
-
-#include "nrf_log.h"
-#include "nrf_log_ctrl.h"
-//#include "nrf_log_default_backends.h"
-
-#ifdef __cplusplus
-}
-#endif
-
-
-#define FLASH_STORAGE_DEBUG_READ            1
-#define FLASH_STORAGE_DEBUG_ERASE_PAGE      1
-#define FLASH_STORAGE_DEBUG_WRITE           1
+#include "EEPROM_ll.h"
 
 /*
     The NRF52833 has 128 pages of 4KB each one.
@@ -102,6 +75,15 @@ extern "C"
 
         Page 0   (0x00000000) -> MBR.
 
+    Wear leveling ( FLASH_STORAGE_WL_NUM_PAGES > 0 ):
+        The EEPROM space is spread over FLASH_STORAGE_WL_NUM_PAGES pages taken from the main app space right
+        below the FDS pages ( page 111 and down ). Every physical page starts with a header holding its erase
+        counter, the logical page it carries and the sequence number of its commit. A logical page is always
+        rewritten into the least worn free physical page, so the old copy stays valid until the new one is
+        committed. The legacy pages 115 and 116 are only read to import the image the first time.
+        The pages are checked to be above the application image at init, and to be within the area the DFU keeps
+        ( FLASH_STORAGE_DFU_APP_DATA_SIZE ) at build time.
+
     Future changes:
         - Reserve only two pages for FDS.
         - Locate the two pages for FDS directly below the bootloader and then the memory pages
@@ -112,103 +94,421 @@ extern "C"
 #define FLASH_STORAGE_PAGE_SIZE                 4096    /* Size of the flash pages in Bytes. */
 #define FLASH_STORAGE_SIZE                      ( FLASH_STORAGE_NUM_PAGES * FLASH_STORAGE_PAGE_SIZE )
 
-#define FLASH_STORAGE_FIRST_PAGE_START_ADDR     flash_first_page_start_addr_get()
-#define FLASH_STORAGE_LAST_PAGE_END_ADDR        flash_last_page_end_addr_get()
-
 #define FLASH_STORAGE_ALIGN                     4       /* The FLASH data is aligned by 4 bytes */
 
-volatile static bool flag_write_completed = false;
-volatile static bool flag_erase_completed = false;
+static uint32_t flash_start_addr = 0;
 
-static void fstorage_evt_handler(nrf_fstorage_evt_t *evt);
-static inline uint32_t flash_first_page_start_addr_get(void);
-static inline uint32_t flash_last_page_end_addr_get(void);
+#if FLASH_STORAGE_WL_NUM_PAGES
 
-// Creates an fstorage instance.
-NRF_FSTORAGE_DEF(nrf_fstorage_t fstorage_instance) = {
-    .evt_handler = fstorage_evt_handler,
+#define FLASH_STORAGE_FDS_NUM_PAGES             3       /* FDS pages right below the legacy EEPROM pages */
+#define FLASH_STORAGE_ENDURANCE                 10000   /* Rated erase cycles of the nRF52833 flash */
 
-    /*
-        You must set these manually, even at runtime, before nrf_fstorage_init() is called.
-        The function nrf5_flash_end_addr_get() can be used to retrieve the last address on the
-        last page of flash available to write data.
-    */
-    .start_addr = FLASH_STORAGE_FIRST_PAGE_START_ADDR,
-    .end_addr = FLASH_STORAGE_LAST_PAGE_END_ADDR,
-};
+#define WL_HEADER_MAGIC                         0x4C574544
+#define WL_PAGE_PAYLOAD_SIZE                    ( FLASH_STORAGE_PAGE_SIZE - sizeof( wl_page_header_t ) )
+#define WL_LOGICAL_PAGES                        ( ( FLASH_STORAGE_SIZE + WL_PAGE_PAYLOAD_SIZE - 1 ) / WL_PAGE_PAYLOAD_SIZE )
+#define WL_PAGE_NONE                            0xFFFF
+#define WL_ERASE_COUNT_NONE                     0xFFFFFFFF
+#define WL_COPY_CHUNK_SIZE                      64
 
-/*
-    This function is used to get the correct flash address even if no bootloader is flashed.
-    The bulk of this function has been taken from Nordic's SDK fds.c module.
-*/
-static inline uint32_t flash_first_page_start_addr_get(void)
+typedef struct
 {
-    uint32_t const bootloader_addr = BOOTLOADER_ADDRESS;
-    uint32_t const page_sz         = NRF_FICR->CODEPAGESIZE;
-
-#if defined(NRF52810_XXAA) || defined(NRF52811_XXAA)
-    // Hardcode the number of flash pages, necessary for SoC emulation.
-    // nRF52810 on nRF52832 and
-    // nRF52811 on nRF52840
-    uint32_t const code_sz = 48;
-#else
-   uint32_t const code_sz = NRF_FICR->CODESIZE;
-#endif
+    uint32_t erase_count;       /* Written right after the page erase */
+    uint32_t logical_page;      /* The rest is written when the page gets committed */
+    uint32_t sequence;
+    uint32_t magic;
+} wl_page_header_t;
+
+typedef struct
+{
+    uint32_t start_addr;
+    uint32_t sequence;                                      /* Sequence of the last commit */
+
+    uint16_t map[ WL_LOGICAL_PAGES ];                       /* Committed physical page of each logical page */
+    uint32_t erase_count[ FLASH_STORAGE_WL_NUM_PAGES ];
+
+    uint16_t open_logical;                                  /* The logical page being written */
+    uint16_t open_physical;
+    uint32_t erase_pending;                                 /* Logical pages erased but not written yet */
 
-    uint32_t end_addr = (bootloader_addr != 0xFFFFFFFF) ? bootloader_addr : (code_sz * page_sz);
+    uint16_t commit_pages;                                  /* Pages committed since the last wl_commit */
+    uint16_t save_pages;                                    /* Pages written by the last save */
+} wl_t;
 
-    return end_addr - FLASH_STORAGE_SIZE;
+static_assert( FLASH_STORAGE_WL_NUM_PAGES > WL_LOGICAL_PAGES, "Wear leveling needs at least one spare page" );
+static_assert( WL_LOGICAL_PAGES <= 32, "The erase_pending mask is too small" );
+static_assert( ( FLASH_STORAGE_NUM_PAGES + FLASH_STORAGE_FDS_NUM_PAGES + FLASH_STORAGE_WL_NUM_PAGES ) * FLASH_STORAGE_PAGE_SIZE <= FLASH_STORAGE_DFU_APP_DATA_SIZE,
+               "The wear leveled pages are out of the area kept by the DFU, check FLASH_STORAGE_DFU_APP_DATA_SIZE" );
+
+static wl_t wl;
+
+static INLINE uint32_t wl_page_addr_get( uint16_t page )
+{
+    return wl.start_addr + page * FLASH_STORAGE_PAGE_SIZE;
 }
 
-static inline uint32_t flash_last_page_end_addr_get(void)
+static INLINE uint16_t wl_page_read_get( uint16_t logical )
 {
-    return flash_first_page_start_addr_get() + FLASH_STORAGE_SIZE - 1;
+    if( logical == wl.open_logical )
+    {
+        return wl.open_physical;
+    }
+    else if( ( wl.erase_pending & ( 1UL << logical ) ) != 0 )
+    {
+        return WL_PAGE_NONE;
+    }
+
+    return wl.map[ logical ];
 }
 
-static void fstorage_evt_handler(nrf_fstorage_evt_t *p_evt)
+static void wl_mount( void )
 {
-    if (p_evt->result != NRF_SUCCESS)
+    wl_page_header_t header;
+    uint32_t sequence[ WL_LOGICAL_PAGES ];
+    uint16_t page;
+
+    wl.sequence = 0;
+    wl.open_logical = WL_PAGE_NONE;
+    wl.open_physical = WL_PAGE_NONE;
+    wl.erase_pending = 0;
+    wl.commit_pages = 0;
+    wl.save_pages = WL_LOGICAL_PAGES;
+
+    for( page = 0; page < WL_LOGICAL_PAGES; page++ )
     {
-        NRF_LOG_ERROR("EEPROM: Error while executing an fstorage operation.");
-        NRF_LOG_FLUSH();
+        wl.map[ page ] = WL_PAGE_NONE;
+        sequence[ page ] = 0;
+    }
+
+    for( page = 0; page < FLASH_STORAGE_WL_NUM_PAGES; page++ )
+    {
+        if( eeprom_ll_read( wl_page_addr_get( page ), (uint8_t *)&header, sizeof( header ) ) != RESULT_OK )
+        {
+            memset( &header, 0xFF, sizeof( header ) );
+        }
+
+        /* The counter of a page which was never erased by us ( or lost by a reset right after the erase ) restarts from zero */
+        wl.erase_count[ page ] = ( header.erase_count == WL_ERASE_COUNT_NONE ) ? 0 : header.erase_count;
+
+        if( header.magic != WL_HEADER_MAGIC || header.logical_page >= WL_LOGICAL_PAGES )
+        {
+            /* Not committed */
+            continue;
+        }
 
-        return;
+        if( wl.map[ header.logical_page ] == WL_PAGE_NONE || header.sequence > sequence[ header.logical_page ] )
+        {
+            wl.map[ header.logical_page ] = page;
+            sequence[ header.logical_page ] = header.sequence;
+        }
+
+        if( header.sequence > wl.sequence )
+        {
+            wl.sequence = header.sequence;
+        }
     }
+}
+
+static INLINE bool_t wl_page_is_free( uint16_t page )
+{
+    uint16_t logical;
 
-    switch (p_evt->id)
+    if( page == wl.open_physical )
     {
-        case NRF_FSTORAGE_EVT_WRITE_RESULT:
+        return false;
+    }
+
+    for( logical = 0; logical < WL_LOGICAL_PAGES; logical++ )
+    {
+        if( wl.map[ logical ] == page )
         {
-#if FLASH_STORAGE_DEBUG_WRITE
-            NRF_LOG_DEBUG("EEPROM: Writing completed.");
-            NRF_LOG_FLUSH();
-#endif
+            return false;
+        }
+    }
+
+    return true;
+}
 
-            flag_write_completed = true;
+static result_t wl_page_open( uint16_t logical )
+{
+    result_t result = RESULT_ERR;
+    uint16_t page_free = WL_PAGE_NONE;
+    uint16_t page;
+
+    if( ( wl.erase_pending & ( 1UL << logical ) ) == 0 )
+    {
+        ASSERT_DYGMA( false, "Writing into a not erased EEPROM page" );
+        return RESULT_ERR;
+    }
+
+    /* Take the least worn free page */
+    for( page = 0; page < FLASH_STORAGE_WL_NUM_PAGES; page++ )
+    {
+        if( wl_page_is_free( page ) == true && ( page_free == WL_PAGE_NONE || wl.erase_count[ page ] < wl.erase_count[ page_free ] ) )
+        {
+            page_free = page;
         }
-        break;
+    }
+
+    if( page_free == WL_PAGE_NONE )
+    {
+        ASSERT_DYGMA( false, "There is no free EEPROM page" );
+        return RESULT_ERR;
+    }
+
+    result = eeprom_ll_erase( wl_page_addr_get( page_free ), 1 );
+    EXIT_IF_ERR( result, "eeprom_ll_erase failed" );
+
+    wl.erase_count[ page_free ]++;
+
+    result = eeprom_ll_write( wl_page_addr_get( page_free ), (const uint8_t *)&wl.erase_count[ page_free ], sizeof( uint32_t ) );
+    EXIT_IF_ERR( result, "eeprom_ll_write failed" );
+
+    wl.erase_pending &= ~( 1UL << logical );
+    wl.open_logical = logical;
+    wl.open_physical = page_free;
+
+_EXIT:
+    return result;
+}
+
+static result_t wl_page_commit( void )
+{
+    result_t result = RESULT_OK;
+    wl_page_header_t header;
+
+    if( wl.open_logical == WL_PAGE_NONE )
+    {
+        /* No page is being written */
+        return RESULT_OK;
+    }
 
-        case NRF_FSTORAGE_EVT_ERASE_RESULT:
+    header.logical_page = wl.open_logical;
+    header.sequence = wl.sequence + 1;
+    header.magic = WL_HEADER_MAGIC;
+
+    /* The erase counter has been written already */
+    result = eeprom_ll_write( wl_page_addr_get( wl.open_physical ) + sizeof( uint32_t ),
+                              (const uint8_t *)&header.logical_page, sizeof( header ) - sizeof( uint32_t ) );
+    EXIT_IF_ERR( result, "eeprom_ll_write failed" );
+
+    /* The new copy takes over and the old one becomes free */
+    wl.sequence = header.sequence;
+    wl.map[ wl.open_logical ] = wl.open_physical;
+
+    wl.open_logical = WL_PAGE_NONE;
+    wl.open_physical = WL_PAGE_NONE;
+    wl.commit_pages++;
+
+_EXIT:
+    return result;
+}
+
+static result_t wl_read( uint32_t addr_offset, uint8_t * p_data, size_t data_size )
+{
+    result_t result = RESULT_OK;
+    uint16_t logical;
+    uint16_t page;
+    uint32_t offset;
+    size_t len;
+
+    while( data_size > 0 )
+    {
+        logical = addr_offset / WL_PAGE_PAYLOAD_SIZE;
+        offset = addr_offset % WL_PAGE_PAYLOAD_SIZE;
+        len = ( data_size < WL_PAGE_PAYLOAD_SIZE - offset ) ? data_size : WL_PAGE_PAYLOAD_SIZE - offset;
+
+        page = wl_page_read_get( logical );
+        if( page == WL_PAGE_NONE )
         {
-#if FLASH_STORAGE_DEBUG_READ or FLASH_STORAGE_DEBUG_WRITE
-            NRF_LOG_DEBUG("EEPROM: Erase completed.");
-            NRF_LOG_FLUSH();
-#endif
+            /* The logical page has not been written yet */
+            memset( p_data, 0xFF, len );
+        }
+        else
+        {
+            result = eeprom_ll_read( wl_page_addr_get( page ) + sizeof( wl_page_header_t ) + offset, p_data, len );
+            EXIT_IF_ERR( result, "eeprom_ll_read failed" );
+        }
+
+        addr_offset += len;
+        p_data += len;
+        data_size -= len;
+    }
+
+_EXIT:
+    return result;
+}
+
+static result_t wl_write( uint32_t addr_offset, const uint8_t * p_data, size_t data_size )
+{
+    result_t result = RESULT_OK;
+    uint16_t logical;
+    uint32_t offset;
+    size_t len;
+
+    while( data_size > 0 )
+    {
+        logical = addr_offset / WL_PAGE_PAYLOAD_SIZE;
+        offset = addr_offset % WL_PAGE_PAYLOAD_SIZE;
+        len = ( data_size < WL_PAGE_PAYLOAD_SIZE - offset ) ? data_size : WL_PAGE_PAYLOAD_SIZE - offset;
+
+        if( logical != wl.open_logical )
+        {
+            /* The previous page is finished */
+            result = wl_page_commit();
+            EXIT_IF_ERR( result, "wl_page_commit failed" );
+
+            result = wl_page_open( logical );
+            EXIT_IF_ERR( result, "wl_page_open failed" );
+        }
+
+        result = eeprom_ll_write( wl_page_addr_get( wl.open_physical ) + sizeof( wl_page_header_t ) + offset, p_data, len );
+        EXIT_IF_ERR( result, "eeprom_ll_write failed" );
+
+        addr_offset += len;
+        p_data += len;
+        data_size -= len;
+    }
+
+_EXIT:
+    return result;
+}
+
+static result_t wl_page_magic_clear( uint16_t page )
+{
+    const uint32_t magic_none = 0;
+
+    /* The magic is the last word of the header */
+    return eeprom_ll_write( wl_page_addr_get( page ) + sizeof( wl_page_header_t ) - sizeof( uint32_t ),
+                            (const uint8_t *)&magic_none, sizeof( magic_none ) );
+}
+
+static result_t wl_page_drop( uint16_t logical )
+{
+    result_t result = RESULT_OK;
+    wl_page_header_t header;
+    uint16_t page;
+
+    /* The older copies go first, so a reset in the middle does not bring back anything older than the last commit */
+    for( page = 0; page < FLASH_STORAGE_WL_NUM_PAGES; page++ )
+    {
+        if( page == wl.map[ logical ] || page == wl.open_physical )
+        {
+            continue;
+        }
+
+        result = eeprom_ll_read( wl_page_addr_get( page ), (uint8_t *)&header, sizeof( header ) );
+        EXIT_IF_ERR( result, "eeprom_ll_read failed" );
+
+        if( header.magic == WL_HEADER_MAGIC && header.logical_page == logical )
+        {
+            result = wl_page_magic_clear( page );
+            EXIT_IF_ERR( result, "wl_page_magic_clear failed" );
+        }
+    }
+
+    if( wl.map[ logical ] != WL_PAGE_NONE )
+    {
+        result = wl_page_magic_clear( wl.map[ logical ] );
+        EXIT_IF_ERR( result, "wl_page_magic_clear failed" );
 
-            flag_erase_completed = true;
+        wl.map[ logical ] = WL_PAGE_NONE;
+    }
+
+_EXIT:
+    return result;
+}
+
+static result_t wl_commit( void )
+{
+    result_t result = RESULT_ERR;
+    uint16_t logical;
+
+    result = wl_page_commit();
+    EXIT_IF_ERR( result, "wl_page_commit failed" );
+
+    /*
+     * The pages which were erased and not written read as erased from now on. Instead of spending an erase cycle on
+     * an empty copy, the magic of their copies is cleared so they are not mounted again.
+     */
+    for( logical = 0; logical < WL_LOGICAL_PAGES; logical++ )
+    {
+        if( ( wl.erase_pending & ( 1UL << logical ) ) == 0 )
+        {
+            continue;
         }
-        break;
 
-        default:
+        result = wl_page_drop( logical );
+        EXIT_IF_ERR( result, "wl_page_drop failed" );
+
+        wl.erase_pending &= ~( 1UL << logical );
+    }
+
+    wl.save_pages = ( wl.commit_pages > 0 ) ? wl.commit_pages : 1;
+    wl.commit_pages = 0;
+
+_EXIT:
+    return result;
+}
+
+static result_t wl_legacy_import( void )
+{
+    result_t result = RESULT_OK;
+    uint8_t chunk[ WL_COPY_CHUNK_SIZE ] __attribute__((aligned(4)));
+    uint32_t offset;
+    uint16_t logical;
+    bool_t blank = true;
+    size_t i;
+
+    for( logical = 0; logical < WL_LOGICAL_PAGES; logical++ )
+    {
+        if( wl.map[ logical ] != WL_PAGE_NONE )
+        {
+            /* The wear leveled space is in use already */
+            return RESULT_OK;
+        }
+    }
+
+    for( offset = 0; offset < FLASH_STORAGE_SIZE && blank == true; offset += sizeof( chunk ) )
+    {
+        result = eeprom_ll_read( flash_start_addr + offset, chunk, sizeof( chunk ) );
+        EXIT_IF_ERR( result, "eeprom_ll_read failed" );
+
+        for( i = 0; i < sizeof( chunk ); i++ )
         {
+            blank = ( chunk[ i ] == 0xFF ) ? blank : false;
         }
-        break;
     }
+
+    if( blank == true )
+    {
+        /* Nothing to import */
+        return RESULT_OK;
+    }
+
+    wl.erase_pending = ( 1UL << WL_LOGICAL_PAGES ) - 1;
+
+    for( offset = 0; offset < FLASH_STORAGE_SIZE; offset += sizeof( chunk ) )
+    {
+        result = eeprom_ll_read( flash_start_addr + offset, chunk, sizeof( chunk ) );
+        EXIT_IF_ERR( result, "eeprom_ll_read failed" );
+
+        result = wl_write( offset, chunk, sizeof( chunk ) );
+        EXIT_IF_ERR( result, "wl_write failed" );
+    }
+
+    result = wl_commit();
+    EXIT_IF_ERR( result, "wl_commit failed" );
+
+_EXIT:
+    return result;
 }
 
+#endif /* FLASH_STORAGE_WL_NUM_PAGES */
+
 result_t EEPROMClass::init( void )
 {
-    nrf_fstorage_api_t *fs_api;
+    result_t result = RESULT_ERR;
+    uint32_t flash_end;
 
     if( initialized == true )
     {
@@ -216,34 +516,38 @@ result_t EEPROMClass::init( void )
         return RESULT_OK;
     }
 
-#ifdef SOFTDEVICE_PRESENT
-#if FLASH_STORAGE_DEBUG_READ or FLASH_STORAGE_DEBUG_WRITE
-    NRF_LOG_DEBUG("EEPROM: SoftDevice is present. Using nrf_fstorage_sd driver implementation.");
-    NRF_LOG_FLUSH();
-#endif
+    /* The legacy EEPROM space is located right below the bootloader */
+    flash_end = eeprom_ll_flash_end_get();
+    flash_start_addr = flash_end - FLASH_STORAGE_SIZE;
 
-    fs_api = &nrf_fstorage_sd;
-#else
-#if FLASH_STORAGE_DEBUG_READ or FLASH_STORAGE_DEBUG_WRITE
-    NRF_LOG_DEBUG("EEPROM: SoftDevice not present. Using nrf_fstorage_nvmc driver implementation.");
-    NRF_LOG_FLUSH();
-#endif
-
-    fs_api = &nrf_fstorage_nvmc;
-#endif
+#if FLASH_STORAGE_WL_NUM_PAGES
+    /* The wear leveled space is located below the FDS pages */
+    wl.start_addr = flash_start_addr - ( FLASH_STORAGE_FDS_NUM_PAGES + FLASH_STORAGE_WL_NUM_PAGES ) * FLASH_STORAGE_PAGE_SIZE;
 
-    ret_code_t rc = nrf_fstorage_init(&fstorage_instance, fs_api, NULL);
-    if( rc != NRF_SUCCESS )
+    if( eeprom_ll_app_end_get() > wl.start_addr )
     {
+        ASSERT_DYGMA( false, "The wear leveled EEPROM pages overlap the application image" );
         return RESULT_ERR;
     }
-    APP_ERROR_CHECK(rc);
+
+    result = eeprom_ll_init( wl.start_addr, flash_end );
+    EXIT_IF_ERR( result, "eeprom_ll_init failed" );
+
+    wl_mount();
+
+    result = wl_legacy_import();
+    EXIT_IF_ERR( result, "wl_legacy_import failed" );
+#else
+    result = eeprom_ll_init( flash_start_addr, flash_end );
+    EXIT_IF_ERR( result, "eeprom_ll_init failed" );
+#endif
 
     /* Initially, the whole EEPROM space is protected and forcing the erase needs to be called before any write */
     addr_offset_protected = FLASH_STORAGE_SIZE;
     initialized = true;
 
-    return RESULT_OK;
+_EXIT:
+    return result;
 }
 
 uint32_t EEPROMClass::align_get(void)
@@ -251,6 +555,38 @@ uint32_t EEPROMClass::align_get(void)
     return FLASH_STORAGE_ALIGN;
 }
 
+uint32_t EEPROMClass::page_size_get(void)
+{
+#if FLASH_STORAGE_WL_NUM_PAGES
+    return WL_PAGE_PAYLOAD_SIZE;
+#else
+    return FLASH_STORAGE_PAGE_SIZE;
+#endif
+}
+
+uint32_t EEPROMClass::size_get(void)
+{
+    return FLASH_STORAGE_SIZE;
+}
+
+const uint8_t * EEPROMClass::ptr_get( uint32_t addr_offset )
+{
+#if FLASH_STORAGE_WL_NUM_PAGES
+    UNUSED( addr_offset );
+
+    ASSERT_DYGMA(false, "The wear leveled EEPROM space is not mapped contiguously");
+    return NULL;
+#else
+    if( addr_offset >= FLASH_STORAGE_SIZE )
+    {
+        ASSERT_DYGMA(false, "EEPROM available space overflow");
+        return NULL;
+    }
+
+    return eeprom_ll_ptr_get( flash_start_addr + addr_offset );
+#endif
+}
+
 result_t EEPROMClass::read( uint32_t addr_offset, uint8_t * p_data, size_t data_size )
 {
     if (data_size == 0)
@@ -264,28 +600,17 @@ result_t EEPROMClass::read( uint32_t addr_offset, uint8_t * p_data, size_t data_
         return RESULT_ERR;
     }
 
-    while (nrf_fstorage_is_busy( &fstorage_instance ))  // Wait until fstorage is available.
-    {
-        yield();  // Meanwhile execute tasks.
-    }
-
-    // At startup, EEPROMclass loads all the flash memory pages it uses.
-    ret_code_t ret_code = nrf_fstorage_read( &fstorage_instance, FLASH_STORAGE_FIRST_PAGE_START_ADDR + addr_offset, p_data, data_size );
-    if ( ret_code != NRF_SUCCESS )
-    {
-        return RESULT_ERR;
-    }
-
-#if FLASH_STORAGE_DEBUG_READ
-    NRF_LOG_DEBUG("EEPROM: Loaded flash memory, ret_code = %i", ret_code);
-    NRF_LOG_FLUSH();
+#if FLASH_STORAGE_WL_NUM_PAGES
+    return wl_read( addr_offset, p_data, data_size );
+#else
+    return eeprom_ll_read( flash_start_addr + addr_offset, p_data, data_size );
 #endif
-
-    return RESULT_OK;
 }
 
 result_t EEPROMClass::write( uint32_t addr_offset, const uint8_t * p_data, size_t data_size )
 {
+    result_t result = RESULT_ERR;
+
     if (data_size == 0)
     {
         /* Nothing to write */
@@ -302,114 +627,131 @@ result_t EEPROMClass::write( uint32_t addr_offset, const uint8_t * p_data, size_
         return RESULT_ERR;
     }
 
-    while (nrf_fstorage_is_busy( &fstorage_instance ))  // Wait until fstorage is available.
-    {
-        yield();  // Meanwhile execute tasks.
-    }
-
-#if FLASH_STORAGE_DEBUG_ERASE_PAGE
-    NRF_LOG_DEBUG("EEPROM: Writing flash...");
-    NRF_LOG_FLUSH();
+#if FLASH_STORAGE_WL_NUM_PAGES
+    result = wl_write( addr_offset, p_data, data_size );
+    EXIT_IF_ERR( result, "wl_write failed" );
+#else
+    result = eeprom_ll_write( flash_start_addr + addr_offset, p_data, data_size );
+    EXIT_IF_ERR( result, "eeprom_ll_write failed" );
 #endif
-    flag_write_completed = false;
-    ret_code_t ret_code = nrf_fstorage_write(&fstorage_instance,
-                                             FLASH_STORAGE_FIRST_PAGE_START_ADDR + addr_offset,
-                                             p_data,
-                                             data_size,
-                                             NULL);
-    if (ret_code != NRF_SUCCESS)
-    {
-        NRF_LOG_ERROR("EEPROM: Write error, ret_code = %d", ret_code);
-        NRF_LOG_FLUSH();
 
-        /*
-            If error, try increasing NRF_FSTORAGE_SD_MAX_RETRIES and NRF_FSTORAGE_SD_QUEUE_SIZE.
+    /* Shift the protected address offset */
+    addr_offset_protected = addr_offset + data_size;
 
-            Error codes:
-            ret = 14 -> NRF_ERROR_NULL: If p_fs or p_src is NULL.
-            ret = 8  -> NRF_ERROR_INVALID_STATE: If the module is not initialized.
-            ret = 9  -> NRF_ERROR_INVALID_LENGTH: If len is zero or not a multiple of the program unit, or if it is otherwise invalid.
-            ret = 16 -> NRF_ERROR_INVALID_ADDR: If the address dest is outside the flash memory boundaries specified in p_fs, or if it is unaligned.
-            ret = 4  -> NRF_ERROR_NO_MEM: If no memory is available to accept the operation. When using the SoftDevice implementation, this error indicates that the
-           internal queue of operations is full.
-        */
+_EXIT:
+    return result;
+}
 
-        flag_write_completed = true;
+result_t EEPROMClass::pages_erase( uint32_t page, uint32_t pages_count )
+{
+#if FLASH_STORAGE_WL_NUM_PAGES
+    result_t result = RESULT_ERR;
 
-        return RESULT_ERR;
-    }
+    /* Finish the page being written. The erased pages get their new copies when written or committed */
+    result = wl_page_commit();
+    EXIT_IF_ERR( result, "wl_page_commit failed" );
 
-    /*
-        The operation was accepted.
-        Upon completion, the NRF_FSTORAGE_ERASE_RESULT event is sent to the callback function
-        registered by the instance.
+    wl.erase_pending |= ( ( 1UL << pages_count ) - 1 ) << page;
 
-        If error, try increasing NRF_FSTORAGE_SD_MAX_RETRIES and NRF_FSTORAGE_SD_QUEUE_SIZE.
-    */
-    while (!flag_write_completed)
-    {
-        yield();  // Meanwhile execute tasks.
-    }
+_EXIT:
+    return result;
+#else
+    return eeprom_ll_erase( flash_start_addr + page * FLASH_STORAGE_PAGE_SIZE, pages_count );
+#endif
+}
 
-    /* Shift the protected address offset */
-    addr_offset_protected = addr_offset + data_size;
+result_t EEPROMClass::erase(void)
+{
+    result_t result = RESULT_ERR;
 
-    return RESULT_OK;
+#if FLASH_STORAGE_WL_NUM_PAGES
+    result = pages_erase( 0, WL_LOGICAL_PAGES );
+#else
+    result = pages_erase( 0, FLASH_STORAGE_NUM_PAGES );
+#endif
+    EXIT_IF_ERR( result, "pages_erase failed" );
+
+    addr_offset_protected = 0;
+
+_EXIT:
+    return result;
 }
 
-result_t EEPROMClass::erase(void)
+result_t EEPROMClass::page_erase( uint32_t page )
 {
-    while (nrf_fstorage_is_busy( &fstorage_instance ))  // Wait until fstorage is available.
+    result_t result = RESULT_ERR;
+
+    if( page * page_size_get() >= FLASH_STORAGE_SIZE )
     {
-        yield();  // Meanwhile execute tasks.
+        ASSERT_DYGMA(false, "EEPROM page out of range");
+        return RESULT_ERR;
     }
 
-#if FLASH_STORAGE_DEBUG_ERASE_PAGE
-    NRF_LOG_DEBUG("EEPROM: Erasing flash...");
-    NRF_LOG_FLUSH();
+    result = pages_erase( page, 1 );
+    EXIT_IF_ERR( result, "pages_erase failed" );
+
+    /* The addresses below the erased page keep being protected */
+    addr_offset_protected = page * page_size_get();
+
+_EXIT:
+    return result;
+}
+
+result_t EEPROMClass::commit(void)
+{
+#if FLASH_STORAGE_WL_NUM_PAGES
+    return wl_commit();
+#else
+    /* The data is in its place already */
+    return RESULT_OK;
 #endif
-    flag_erase_completed = false;
-    ret_code_t ret_code = nrf_fstorage_erase(&fstorage_instance,
-                                             FLASH_STORAGE_FIRST_PAGE_START_ADDR,
-                                             FLASH_STORAGE_NUM_PAGES,
-                                             NULL);
-    if (ret_code != NRF_SUCCESS)
-    {
-        NRF_LOG_ERROR("EEPROM: Erase error, ret_code = %lu", ret_code);
-        NRF_LOG_FLUSH();
+}
 
-        /*
-            If error, try increasing NRF_FSTORAGE_SD_MAX_RETRIES and NRF_FSTORAGE_SD_QUEUE_SIZE.
+result_t EEPROMClass::wear_get( eeprom_wear_t * p_wear )
+{
+#if FLASH_STORAGE_WL_NUM_PAGES
+    uint64_t cycles_remaining = 0;
+    uint16_t page;
 
-            Error codes:
-            ret = 14 -> NRF_ERROR_NULL: If p_fs or p_src is NULL.
-            ret = 8  -> NRF_ERROR_INVALID_STATE: If the module is not initialized.
-            ret = 9  -> NRF_ERROR_INVALID_LENGTH: If len is zero or not a multiple of the program unit, or if it is otherwise invalid.
-            ret = 16 -> NRF_ERROR_INVALID_ADDR: If the address dest is outside the flash memory boundaries specified in p_fs, or if it is unaligned.
-            ret = 4  -> NRF_ERROR_NO_MEM: If no memory is available to accept the operation. When using the SoftDevice implementation, this error indicates that the
-           internal queue of operations is full.
-        */
+    p_wear->pages_count = FLASH_STORAGE_WL_NUM_PAGES;
+    p_wear->erase_count_min = wl.erase_count[ 0 ];
+    p_wear->erase_count_max = wl.erase_count[ 0 ];
 
-        flag_erase_completed = true;
+    for( page = 0; page < FLASH_STORAGE_WL_NUM_PAGES; page++ )
+    {
+        p_wear->erase_count_min = ( wl.erase_count[ page ] < p_wear->erase_count_min ) ? wl.erase_count[ page ] : p_wear->erase_count_min;
+        p_wear->erase_count_max = ( wl.erase_count[ page ] > p_wear->erase_count_max ) ? wl.erase_count[ page ] : p_wear->erase_count_max;
 
-        return RESULT_ERR;
+        cycles_remaining += ( wl.erase_count[ page ] < FLASH_STORAGE_ENDURANCE ) ? FLASH_STORAGE_ENDURANCE - wl.erase_count[ page ] : 0;
     }
 
-    /*
-        The operation was accepted.
-        Upon completion, the NRF_FSTORAGE_ERASE_RESULT event is sent to the callback function
-        registered by the instance.
+    /* Every save rewrites the logical pages written, so the last one is taken as the estimation */
+    p_wear->life_remaining = ( cycles_remaining * 100 ) / ( (uint64_t)FLASH_STORAGE_WL_NUM_PAGES * FLASH_STORAGE_ENDURANCE );
+    p_wear->saves_remaining = cycles_remaining / wl.save_pages;
+
+    return RESULT_OK;
+#else
+    /* The legacy pages keep no erase counters */
+    memset( p_wear, 0, sizeof( eeprom_wear_t ) );
+
+    return RESULT_OK;
+#endif
+}
 
-        If error, try increasing NRF_FSTORAGE_SD_MAX_RETRIES and NRF_FSTORAGE_SD_QUEUE_SIZE.
-    */
-    while (!flag_erase_completed)
+uint32_t EEPROMClass::page_erase_count_get( uint16_t page )
+{
+#if FLASH_STORAGE_WL_NUM_PAGES
+    if( page >= FLASH_STORAGE_WL_NUM_PAGES )
     {
-        yield();  // Meanwhile execute tasks.
+        return 0;
     }
 
-    addr_offset_protected = 0;
+    return wl.erase_count[ page ];
+#else
+    UNUSED( page );
 
-    return RESULT_OK;
+    return 0;
+#endif
 }
 
 EEPROMClass EEPROM;
@@ -30,19 +30,61 @@
 
 #include "dl_middleware.h"
 
+/*
+ * Wear leveling. When set, the EEPROM space is spread over FLASH_STORAGE_WL_NUM_PAGES flash pages placed below the FDS
+ * pages and every save rotates the pages according to their erase counters. The image stored in the legacy EEPROM
+ * pages is imported the first time. 0 keeps the legacy fixed pages right below the bootloader.
+ *
+ * NOTE: The default FLASH_STORAGE_DFU_APP_DATA_SIZE only covers the legacy EEPROM and the FDS pages, so turning this on
+ * also needs FLASH_STORAGE_DFU_APP_DATA_SIZE raised to at least ( 5 + FLASH_STORAGE_WL_NUM_PAGES ) * 0x1000, matching
+ * the NRF_DFU_APP_DATA_AREA_SIZE of the bootloader. The build fails otherwise.
+ */
+#ifndef FLASH_STORAGE_WL_NUM_PAGES
+#define FLASH_STORAGE_WL_NUM_PAGES      0
+#endif
+
+/*
+ * Size of the flash area below the bootloader which the DFU keeps untouched ( NRF_DFU_APP_DATA_AREA_SIZE of the
+ * bootloader ). The wear leveled pages must be within it, or the dual bank update would overwrite them.
+ */
+#ifndef FLASH_STORAGE_DFU_APP_DATA_SIZE
+#define FLASH_STORAGE_DFU_APP_DATA_SIZE     0x5000      /* The legacy EEPROM and the FDS pages */
+#endif
+
+typedef struct
+{
+    uint16_t pages_count;           /* Zero when wear leveling is off, as the legacy pages keep no erase counters */
+    uint32_t erase_count_min;
+    uint32_t erase_count_max;
+    uint8_t life_remaining;         /* Percentage of the rated erase cycles left in the whole region */
+    uint32_t saves_remaining;       /* Estimation of the full image saves left */
+} eeprom_wear_t;
+
 class EEPROMClass
 {
     public:
         result_t init( void );
         uint32_t align_get(void);
+        uint32_t page_size_get(void);
+        uint32_t size_get(void);
+
+        /* Returns the memory mapped address of the EEPROM space for reading the data in place */
+        const uint8_t * ptr_get( uint32_t addr_offset );
 
         result_t read( uint32_t addr_offset, uint8_t * p_data, size_t data_size );
         result_t write( uint32_t addr_offset, const uint8_t * p_data, size_t data_size );
         result_t erase(void);
+        result_t page_erase( uint32_t page );
+        result_t commit(void);      /* Needs to be called after the writes following the erase are finished */
+
+        result_t wear_get( eeprom_wear_t * p_wear );
+        uint32_t page_erase_count_get( uint16_t page );
 
     private:
         bool_t initialized = false;
         uint32_t addr_offset_protected = 0;  /* Used to protect already written addresses to prevent multiple address writes */
+
+        result_t pages_erase( uint32_t page, uint32_t pages_count );
 };
 
 extern EEPROMClass EEPROM;
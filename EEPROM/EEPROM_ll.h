@@ -0,0 +1,82 @@
+/*
+ *  EEPROM_ll.h - EEPROM emulation low level flash interface
+ *  Copyright (C) 2026  Dygma Lab S.L. All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __EEPROM_LL_H_
+#define __EEPROM_LL_H_
+
+#include "dl_middleware.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The flash backend of the EEPROMClass. The target one ( EEPROM_ll_nrf.cpp ) uses the nrf_fstorage library and
+ * the host one ( EEPROM_ll_host.cpp, selected by EEPROM_LL_HOST ) simulates the flash in a memory mapped file.
+ *
+ * All the addresses are the absolute flash addresses. The operations are blocking.
+ */
+
+/* Initializes the flash space [ start_addr, end_addr ) to be used */
+extern result_t eeprom_ll_init( uint32_t start_addr, uint32_t end_addr );
+/* Returns the first address after the flash space available to the application */
+extern uint32_t eeprom_ll_flash_end_get( void );
+/* Returns the first address after the application image, including its initialized data */
+extern uint32_t eeprom_ll_app_end_get( void );
+
+extern const uint8_t * eeprom_ll_ptr_get( uint32_t addr );
+
+extern result_t eeprom_ll_read( uint32_t addr, uint8_t * p_data, size_t data_size );
+extern result_t eeprom_ll_write( uint32_t addr, const uint8_t * p_data, size_t data_size );
+extern result_t eeprom_ll_erase( uint32_t addr, uint32_t pages_count );
+
+/*
+ * Flash operations profiler. The stall is the whole time the caller is blocked in the operation ( including the wait
+ * for the previous one ), the completion is the time from the operation submission to its completion event.
+ * All the times are in us. Disabled by default, it is meant for the debug builds.
+ */
+#ifndef EEPROM_LL_PROF_ENABLED
+#define EEPROM_LL_PROF_ENABLED      0
+#endif
+
+typedef enum
+{
+    EEPROM_LL_OP_READ = 0,
+    EEPROM_LL_OP_WRITE,
+    EEPROM_LL_OP_ERASE,
+
+    EEPROM_LL_OP_COUNT,
+} eeprom_ll_op_t;
+
+typedef struct
+{
+    dl_stats_t stall;
+    dl_stats_t completion;
+} eeprom_ll_prof_t;
+
+#if EEPROM_LL_PROF_ENABLED
+extern const eeprom_ll_prof_t * eeprom_ll_prof_get( eeprom_ll_op_t op );
+extern void eeprom_ll_prof_reset( void );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EEPROM_LL_H_ */
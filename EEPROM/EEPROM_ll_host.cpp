@@ -0,0 +1,313 @@
+/*
+ *  EEPROM_ll_host.cpp - EEPROM emulation flash backend simulated on the host
+ *  Copyright (C) 2026  Dygma Lab S.L. All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef EEPROM_LL_HOST
+
+#include "EEPROM_ll.h"
+#include "EEPROM_ll_host.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define EEPROM_LL_HOST_ALIGN                4
+
+#define EEPROM_LL_HOST_FILE_PATH_DEFAULT    "eeprom_flash.bin"
+#define EEPROM_LL_HOST_FLASH_END_DEFAULT    0x00075000      /* Bootloader start address */
+#define EEPROM_LL_HOST_APP_END_DEFAULT      0x00027000      /* Minimum main app start address */
+
+/* nRF52833 Product Specification, NVMC electrical specification */
+#define EEPROM_LL_HOST_WRITE_WORD_US        41
+#define EEPROM_LL_HOST_ERASE_PAGE_US        85000
+
+typedef struct
+{
+    int fd;
+    uint8_t * p_map;
+
+    uint32_t start_addr;
+    uint32_t end_addr;
+} host_flash_t;
+
+static eeprom_ll_host_config_t host_config =
+{
+    .p_file_path = EEPROM_LL_HOST_FILE_PATH_DEFAULT,
+    .flash_end = EEPROM_LL_HOST_FLASH_END_DEFAULT,
+    .app_end = EEPROM_LL_HOST_APP_END_DEFAULT,
+    .op_overhead_us = 0,
+    .write_word_us = EEPROM_LL_HOST_WRITE_WORD_US,
+    .erase_page_us = EEPROM_LL_HOST_ERASE_PAGE_US,
+    .realtime = false,
+};
+
+static host_flash_t host_flash =
+{
+    .fd = -1,
+    .p_map = NULL,
+    .start_addr = 0,
+    .end_addr = 0,
+};
+
+static eeprom_ll_host_stats_t host_stats;
+
+#if EEPROM_LL_PROF_ENABLED
+static eeprom_ll_prof_t prof[ EEPROM_LL_OP_COUNT ];
+#endif
+
+static void host_busy( eeprom_ll_op_t op, uint64_t time_us )
+{
+    struct timespec ts;
+
+    host_stats.busy_time_us += time_us;
+
+#if EEPROM_LL_PROF_ENABLED
+    /* The simulated operations complete when their latency passes */
+    dl_stats_add( &prof[ op ].stall, time_us );
+    dl_stats_add( &prof[ op ].completion, time_us );
+#else
+    UNUSED( op );
+#endif
+
+    if( host_config.realtime == false )
+    {
+        return;
+    }
+
+    ts.tv_sec = time_us / 1000000;
+    ts.tv_nsec = ( time_us % 1000000 ) * 1000;
+
+    while( nanosleep( &ts, &ts ) != 0 )
+    {
+        /* Interrupted by a signal, sleep the rest */
+    }
+}
+
+static bool_t host_range_check( uint32_t addr, size_t size )
+{
+    if( host_flash.p_map == NULL || addr < host_flash.start_addr || addr + size > host_flash.end_addr )
+    {
+        return false;
+    }
+
+    return true;
+}
+
+static void host_flash_close( void )
+{
+    if( host_flash.p_map != NULL )
+    {
+        munmap( host_flash.p_map, host_flash.end_addr - host_flash.start_addr );
+        host_flash.p_map = NULL;
+    }
+
+    if( host_flash.fd >= 0 )
+    {
+        close( host_flash.fd );
+        host_flash.fd = -1;
+    }
+}
+
+void eeprom_ll_host_config_default_get( eeprom_ll_host_config_t * p_config )
+{
+    p_config->p_file_path = EEPROM_LL_HOST_FILE_PATH_DEFAULT;
+    p_config->flash_end = EEPROM_LL_HOST_FLASH_END_DEFAULT;
+    p_config->app_end = EEPROM_LL_HOST_APP_END_DEFAULT;
+    p_config->op_overhead_us = 0;
+    p_config->write_word_us = EEPROM_LL_HOST_WRITE_WORD_US;
+    p_config->erase_page_us = EEPROM_LL_HOST_ERASE_PAGE_US;
+    p_config->realtime = false;
+}
+
+void eeprom_ll_host_config_set( const eeprom_ll_host_config_t * p_config )
+{
+    host_config = *p_config;
+}
+
+const eeprom_ll_host_stats_t * eeprom_ll_host_stats_get( void )
+{
+    return &host_stats;
+}
+
+void eeprom_ll_host_stats_reset( void )
+{
+    memset( &host_stats, 0x00, sizeof( host_stats ) );
+}
+
+result_t eeprom_ll_init( uint32_t start_addr, uint32_t end_addr )
+{
+    struct stat file_stat;
+    size_t size = end_addr - start_addr;
+    size_t size_prev;
+    void * p_map;
+
+    if( (start_addr % EEPROM_LL_HOST_PAGE_SIZE) != 0 || (end_addr % EEPROM_LL_HOST_PAGE_SIZE) != 0 || end_addr <= start_addr )
+    {
+        ASSERT_DYGMA( false, "The simulated flash space must consist of whole pages" );
+        return RESULT_ERR;
+    }
+
+    host_flash_close();
+
+    host_flash.fd = open( host_config.p_file_path, O_RDWR | O_CREAT, 0644 );
+    if( host_flash.fd < 0 || fstat( host_flash.fd, &file_stat ) != 0 )
+    {
+        host_flash_close();
+        return RESULT_ERR;
+    }
+
+    size_prev = ( (size_t)file_stat.st_size < size ) ? file_stat.st_size : size;
+    if( (size_t)file_stat.st_size < size && ftruncate( host_flash.fd, size ) != 0 )
+    {
+        host_flash_close();
+        return RESULT_ERR;
+    }
+
+    p_map = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, host_flash.fd, 0 );
+    if( p_map == MAP_FAILED )
+    {
+        host_flash_close();
+        return RESULT_ERR;
+    }
+
+    host_flash.p_map = (uint8_t *)p_map;
+    host_flash.start_addr = start_addr;
+    host_flash.end_addr = end_addr;
+
+    /* The flash which was not in the file yet comes erased */
+    memset( &host_flash.p_map[ size_prev ], 0xFF, size - size_prev );
+
+    return RESULT_OK;
+}
+
+uint32_t eeprom_ll_flash_end_get( void )
+{
+    return host_config.flash_end;
+}
+
+uint32_t eeprom_ll_app_end_get( void )
+{
+    return host_config.app_end;
+}
+
+const uint8_t * eeprom_ll_ptr_get( uint32_t addr )
+{
+    if( host_range_check( addr, 0 ) == false )
+    {
+        return NULL;
+    }
+
+    return &host_flash.p_map[ addr - host_flash.start_addr ];
+}
+
+result_t eeprom_ll_read( uint32_t addr, uint8_t * p_data, size_t data_size )
+{
+    if( host_range_check( addr, data_size ) == false )
+    {
+        return RESULT_ERR;
+    }
+
+    memcpy( p_data, &host_flash.p_map[ addr - host_flash.start_addr ], data_size );
+
+    host_stats.read_count++;
+    host_stats.bytes_read += data_size;
+
+    host_busy( EEPROM_LL_OP_READ, 0 );
+
+    return RESULT_OK;
+}
+
+result_t eeprom_ll_write( uint32_t addr, const uint8_t * p_data, size_t data_size )
+{
+    uint8_t * p_flash;
+    bool_t overprogram = false;
+    size_t i;
+
+    if( host_range_check( addr, data_size ) == false )
+    {
+        return RESULT_ERR;
+    }
+    else if( (addr % EEPROM_LL_HOST_ALIGN) != 0 || (data_size % EEPROM_LL_HOST_ALIGN) != 0 )
+    {
+        /* The same as the fstorage, the NVMC writes whole words only */
+        return RESULT_ERR;
+    }
+
+    p_flash = &host_flash.p_map[ addr - host_flash.start_addr ];
+
+    for( i = 0; i < data_size; i++ )
+    {
+        /* Programming can only clear the bits */
+        if( ( p_data[ i ] & ~p_flash[ i ] ) != 0 )
+        {
+            overprogram = true;
+        }
+
+        p_flash[ i ] &= p_data[ i ];
+    }
+
+    host_stats.write_count++;
+    host_stats.bytes_written += data_size;
+    host_stats.overprogram_count += ( overprogram == true ) ? 1 : 0;
+
+    host_busy( EEPROM_LL_OP_WRITE, host_config.op_overhead_us + (uint64_t)( data_size / EEPROM_LL_HOST_ALIGN ) * host_config.write_word_us );
+
+    return RESULT_OK;
+}
+
+result_t eeprom_ll_erase( uint32_t addr, uint32_t pages_count )
+{
+    uint32_t page = addr / EEPROM_LL_HOST_PAGE_SIZE;
+    uint32_t i;
+
+    if( host_range_check( addr, pages_count * EEPROM_LL_HOST_PAGE_SIZE ) == false || (addr % EEPROM_LL_HOST_PAGE_SIZE) != 0 )
+    {
+        return RESULT_ERR;
+    }
+
+    memset( &host_flash.p_map[ addr - host_flash.start_addr ], 0xFF, pages_count * EEPROM_LL_HOST_PAGE_SIZE );
+
+    for( i = 0; i < pages_count && page + i < EEPROM_LL_HOST_PAGES_MAX; i++ )
+    {
+        host_stats.page_erase_count[ page + i ]++;
+    }
+
+    host_stats.erase_count++;
+
+    host_busy( EEPROM_LL_OP_ERASE, host_config.op_overhead_us + (uint64_t)pages_count * host_config.erase_page_us );
+
+    return RESULT_OK;
+}
+
+#if EEPROM_LL_PROF_ENABLED
+const eeprom_ll_prof_t * eeprom_ll_prof_get( eeprom_ll_op_t op )
+{
+    ASSERT_DYGMA( op < EEPROM_LL_OP_COUNT, "Invalid EEPROM operation" );
+
+    return &prof[ op ];
+}
+
+void eeprom_ll_prof_reset( void )
+{
+    memset( prof, 0x00, sizeof( prof ) );
+}
+#endif
+
+#endif /* EEPROM_LL_HOST */
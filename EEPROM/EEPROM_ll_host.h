@@ -0,0 +1,81 @@
+/*
+ *  EEPROM_ll_host.h - EEPROM emulation flash backend simulated on the host
+ *  Copyright (C) 2026  Dygma Lab S.L. All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __EEPROM_LL_HOST_H_
+#define __EEPROM_LL_HOST_H_
+
+#include "dl_middleware.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef EEPROM_LL_HOST
+
+/*
+ * The simulated flash behaves as the nRF52 one: 4 KB pages, erased to 0xFF, word aligned writes which can only
+ * clear bits and the per-operation latencies. The latencies are accounted into the statistics and optionally also
+ * spent in real time, so the host benchmarks can measure the save latency, write amplification and wear.
+ */
+
+#define EEPROM_LL_HOST_PAGE_SIZE        4096
+#define EEPROM_LL_HOST_PAGES_MAX        128         /* Whole nRF52833 flash */
+
+typedef struct
+{
+    const char * p_file_path;       /* The file backing the simulated flash */
+    uint32_t flash_end;             /* The emulated bootloader start address */
+    uint32_t app_end;               /* The emulated end of the application image */
+
+    /* Latencies. The defaults are the nRF52833 datasheet maximums */
+    uint32_t op_overhead_us;        /* Scheduling overhead of every write and erase ( e.g. the SoftDevice timeslots ) */
+    uint32_t write_word_us;
+    uint32_t erase_page_us;
+    bool_t realtime;                /* Spend the latencies in real time instead of only accounting them */
+} eeprom_ll_host_config_t;
+
+typedef struct
+{
+    uint32_t read_count;
+    uint32_t write_count;
+    uint32_t erase_count;           /* Number of erase operations */
+
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint32_t overprogram_count;     /* Writes trying to set bits back to 1 without the erase */
+
+    uint64_t busy_time_us;          /* The time the flash would keep the application waiting */
+
+    uint32_t page_erase_count[ EEPROM_LL_HOST_PAGES_MAX ];  /* Indexed by the flash page number */
+} eeprom_ll_host_stats_t;
+
+extern void eeprom_ll_host_config_default_get( eeprom_ll_host_config_t * p_config );
+/* Needs to be called before the EEPROM gets initialized */
+extern void eeprom_ll_host_config_set( const eeprom_ll_host_config_t * p_config );
+
+extern const eeprom_ll_host_stats_t * eeprom_ll_host_stats_get( void );
+extern void eeprom_ll_host_stats_reset( void );
+
+#endif /* EEPROM_LL_HOST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EEPROM_LL_HOST_H_ */
@@ -0,0 +1,384 @@
+/*
+ *  EEPROM_ll_nrf.cpp - EEPROM emulation flash backend using the nRF fstorage library
+ *  Copyright (C) 2020  Dygma Lab S.L. All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  Mantainer: Gustavo Gomez Lopez @Noteolvides
+ *  Mantainer: Juan Hauara @JuanHauara
+*/
+
+#ifndef EEPROM_LL_HOST
+
+#include "EEPROM_ll.h"
+#include "Time_counter.h"
+
+#include "Arduino.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "nrf_fstorage.h"
+
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_fstorage_sd.h"
+#else
+#include "nrf_fstorage_nvmc.h"
+#endif
+
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+//#include "nrf_log_default_backends.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#define FLASH_STORAGE_DEBUG_READ            1
+#define FLASH_STORAGE_DEBUG_ERASE_PAGE      1
+#define FLASH_STORAGE_DEBUG_WRITE           1
+
+volatile static bool flag_write_completed = false;
+volatile static bool flag_erase_completed = false;
+volatile static bool flag_log_flush_pending = false;
+
+#if EEPROM_LL_PROF_ENABLED
+static eeprom_ll_prof_t prof[ EEPROM_LL_OP_COUNT ];
+volatile static systim_tick_t prof_evt_time = 0;   /* Time of the last completion event */
+
+#define PROF_TIME_GET( time )                   systim_tick_t time = timer_counter_get_micros()
+#define PROF_STALL_ADD( op, start )             dl_stats_add( &prof[ op ].stall, timer_counter_get_micros() - ( start ) )
+#define PROF_COMPLETION_ADD( op, submitted )    dl_stats_add( &prof[ op ].completion, prof_evt_time - ( submitted ) )
+#define PROF_EVT_TIME_SET()                     prof_evt_time = timer_counter_get_micros()
+#else
+#define PROF_TIME_GET( time )
+#define PROF_STALL_ADD( op, start )
+#define PROF_COMPLETION_ADD( op, submitted )
+#define PROF_EVT_TIME_SET()
+#endif
+
+static void fstorage_evt_handler(nrf_fstorage_evt_t *evt);
+
+// Creates an fstorage instance.
+NRF_FSTORAGE_DEF(nrf_fstorage_t fstorage_instance) = {
+    .evt_handler = fstorage_evt_handler,
+
+    /*
+        The flash space is set at runtime by eeprom_ll_init(), before nrf_fstorage_init() is called.
+    */
+    .start_addr = 0,
+    .end_addr = 0,
+};
+
+static void fstorage_log_flush(void * p_ctx, uint32_t arg)
+{
+    UNUSED( p_ctx );
+    UNUSED( arg );
+
+    /* Cleared first, so the messages logged during the flush post a new one */
+    __atomic_store_n( &flag_log_flush_pending, false, __ATOMIC_RELAXED );
+
+    NRF_LOG_FLUSH();
+}
+
+/* The writes and erases complete many times while eeprom_ll_write waits, so only one flush is kept pending */
+static void fstorage_log_flush_post(void)
+{
+    if ( __atomic_exchange_n( &flag_log_flush_pending, true, __ATOMIC_RELAXED ) == true )
+    {
+        return;
+    }
+
+    if ( defer_post( fstorage_log_flush, NULL, 0 ) == false )
+    {
+        /* Dropped, let the next completion try again */
+        flag_log_flush_pending = false;
+    }
+}
+
+/* Runs within the SoC event interrupt. The log is only flushed later in the main loop */
+static void fstorage_evt_handler(nrf_fstorage_evt_t *p_evt)
+{
+    PROF_EVT_TIME_SET();
+
+    if (p_evt->result != NRF_SUCCESS)
+    {
+        NRF_LOG_ERROR("EEPROM: Error while executing an fstorage operation.");
+        fstorage_log_flush_post();
+
+        return;
+    }
+
+    switch (p_evt->id)
+    {
+        case NRF_FSTORAGE_EVT_WRITE_RESULT:
+        {
+#if FLASH_STORAGE_DEBUG_WRITE
+            NRF_LOG_DEBUG("EEPROM: Writing completed.");
+            fstorage_log_flush_post();
+#endif
+
+            flag_write_completed = true;
+        }
+        break;
+
+        case NRF_FSTORAGE_EVT_ERASE_RESULT:
+        {
+#if FLASH_STORAGE_DEBUG_READ or FLASH_STORAGE_DEBUG_WRITE
+            NRF_LOG_DEBUG("EEPROM: Erase completed.");
+            fstorage_log_flush_post();
+#endif
+
+            flag_erase_completed = true;
+        }
+        break;
+
+        default:
+        {
+        }
+        break;
+    }
+}
+
+static void fstorage_wait_ready( void )
+{
+    while (nrf_fstorage_is_busy( &fstorage_instance ))  // Wait until fstorage is available.
+    {
+        yield();  // Meanwhile execute tasks.
+    }
+}
+
+result_t eeprom_ll_init( uint32_t start_addr, uint32_t end_addr )
+{
+    nrf_fstorage_api_t *fs_api;
+
+#ifdef SOFTDEVICE_PRESENT
+#if FLASH_STORAGE_DEBUG_READ or FLASH_STORAGE_DEBUG_WRITE
+    NRF_LOG_DEBUG("EEPROM: SoftDevice is present. Using nrf_fstorage_sd driver implementation.");
+    NRF_LOG_FLUSH();
+#endif
+
+    fs_api = &nrf_fstorage_sd;
+#else
+#if FLASH_STORAGE_DEBUG_READ or FLASH_STORAGE_DEBUG_WRITE
+    NRF_LOG_DEBUG("EEPROM: SoftDevice not present. Using nrf_fstorage_nvmc driver implementation.");
+    NRF_LOG_FLUSH();
+#endif
+
+    fs_api = &nrf_fstorage_nvmc;
+#endif
+
+    fstorage_instance.start_addr = start_addr;
+    fstorage_instance.end_addr = end_addr - 1;
+
+    ret_code_t rc = nrf_fstorage_init(&fstorage_instance, fs_api, NULL);
+    if( rc != NRF_SUCCESS )
+    {
+        return RESULT_ERR;
+    }
+
+    return RESULT_OK;
+}
+
+/*
+    This function is used to get the correct flash address even if no bootloader is flashed.
+    The bulk of this function has been taken from Nordic's SDK fds.c module.
+*/
+uint32_t eeprom_ll_flash_end_get( void )
+{
+    uint32_t const bootloader_addr = BOOTLOADER_ADDRESS;
+    uint32_t const page_sz         = NRF_FICR->CODEPAGESIZE;
+
+#if defined(NRF52810_XXAA) || defined(NRF52811_XXAA)
+    // Hardcode the number of flash pages, necessary for SoC emulation.
+    // nRF52810 on nRF52832 and
+    // nRF52811 on nRF52840
+    uint32_t const code_sz = 48;
+#else
+   uint32_t const code_sz = NRF_FICR->CODESIZE;
+#endif
+
+    return (bootloader_addr != 0xFFFFFFFF) ? bootloader_addr : (code_sz * page_sz);
+}
+
+uint32_t eeprom_ll_app_end_get( void )
+{
+    /* Symbols of the linker script. The initial values of the .data section are stored right after the code */
+    extern uint32_t __etext;
+    extern uint32_t __data_start__;
+    extern uint32_t __data_end__;
+
+    return (uint32_t)&__etext + ( (uint32_t)&__data_end__ - (uint32_t)&__data_start__ );
+}
+
+const uint8_t * eeprom_ll_ptr_get( uint32_t addr )
+{
+    /* The flash is memory mapped, so the data can be read directly from its address */
+    return (const uint8_t *)addr;
+}
+
+result_t eeprom_ll_read( uint32_t addr, uint8_t * p_data, size_t data_size )
+{
+    PROF_TIME_GET( time_start );
+
+    fstorage_wait_ready();
+
+    ret_code_t ret_code = nrf_fstorage_read( &fstorage_instance, addr, p_data, data_size );
+    if ( ret_code != NRF_SUCCESS )
+    {
+        return RESULT_ERR;
+    }
+
+#if FLASH_STORAGE_DEBUG_READ
+    NRF_LOG_DEBUG("EEPROM: Loaded flash memory, ret_code = %i", ret_code);
+    NRF_LOG_FLUSH();
+#endif
+
+    PROF_STALL_ADD( EEPROM_LL_OP_READ, time_start );
+
+    return RESULT_OK;
+}
+
+result_t eeprom_ll_write( uint32_t addr, const uint8_t * p_data, size_t data_size )
+{
+    PROF_TIME_GET( time_start );
+
+    fstorage_wait_ready();
+
+#if FLASH_STORAGE_DEBUG_ERASE_PAGE
+    NRF_LOG_DEBUG("EEPROM: Writing flash...");
+    NRF_LOG_FLUSH();
+#endif
+    PROF_TIME_GET( time_submitted );   /* The nvmc implementation completes within the call */
+    flag_write_completed = false;
+    ret_code_t ret_code = nrf_fstorage_write(&fstorage_instance,
+                                             addr,
+                                             p_data,
+                                             data_size,
+                                             NULL);
+    if (ret_code != NRF_SUCCESS)
+    {
+        NRF_LOG_ERROR("EEPROM: Write error, ret_code = %d", ret_code);
+        NRF_LOG_FLUSH();
+
+        /*
+            If error, try increasing NRF_FSTORAGE_SD_MAX_RETRIES and NRF_FSTORAGE_SD_QUEUE_SIZE.
+
+            Error codes:
+            ret = 14 -> NRF_ERROR_NULL: If p_fs or p_src is NULL.
+            ret = 8  -> NRF_ERROR_INVALID_STATE: If the module is not initialized.
+            ret = 9  -> NRF_ERROR_INVALID_LENGTH: If len is zero or not a multiple of the program unit, or if it is otherwise invalid.
+            ret = 16 -> NRF_ERROR_INVALID_ADDR: If the address dest is outside the flash memory boundaries specified in p_fs, or if it is unaligned.
+            ret = 4  -> NRF_ERROR_NO_MEM: If no memory is available to accept the operation. When using the SoftDevice implementation, this error indicates that the
+           internal queue of operations is full.
+        */
+
+        flag_write_completed = true;
+
+        return RESULT_ERR;
+    }
+
+    /*
+        The operation was accepted.
+        Upon completion, the NRF_FSTORAGE_ERASE_RESULT event is sent to the callback function
+        registered by the instance.
+
+        If error, try increasing NRF_FSTORAGE_SD_MAX_RETRIES and NRF_FSTORAGE_SD_QUEUE_SIZE.
+    */
+    while (!flag_write_completed)
+    {
+        yield();  // Meanwhile execute tasks.
+    }
+
+    PROF_COMPLETION_ADD( EEPROM_LL_OP_WRITE, time_submitted );
+    PROF_STALL_ADD( EEPROM_LL_OP_WRITE, time_start );
+
+    return RESULT_OK;
+}
+
+result_t eeprom_ll_erase( uint32_t addr, uint32_t pages_count )
+{
+    PROF_TIME_GET( time_start );
+
+    fstorage_wait_ready();
+
+#if FLASH_STORAGE_DEBUG_ERASE_PAGE
+    NRF_LOG_DEBUG("EEPROM: Erasing flash...");
+    NRF_LOG_FLUSH();
+#endif
+    PROF_TIME_GET( time_submitted );
+    flag_erase_completed = false;
+    ret_code_t ret_code = nrf_fstorage_erase(&fstorage_instance,
+                                             addr,
+                                             pages_count,
+                                             NULL);
+    if (ret_code != NRF_SUCCESS)
+    {
+        NRF_LOG_ERROR("EEPROM: Erase error, ret_code = %lu", ret_code);
+        NRF_LOG_FLUSH();
+
+        /*
+            If error, try increasing NRF_FSTORAGE_SD_MAX_RETRIES and NRF_FSTORAGE_SD_QUEUE_SIZE.
+
+            Error codes:
+            ret = 14 -> NRF_ERROR_NULL: If p_fs or p_src is NULL.
+            ret = 8  -> NRF_ERROR_INVALID_STATE: If the module is not initialized.
+            ret = 9  -> NRF_ERROR_INVALID_LENGTH: If len is zero or not a multiple of the program unit, or if it is otherwise invalid.
+            ret = 16 -> NRF_ERROR_INVALID_ADDR: If the address dest is outside the flash memory boundaries specified in p_fs, or if it is unaligned.
+            ret = 4  -> NRF_ERROR_NO_MEM: If no memory is available to accept the operation. When using the SoftDevice implementation, this error indicates that the
+           internal queue of operations is full.
+        */
+
+        flag_erase_completed = true;
+
+        return RESULT_ERR;
+    }
+
+    /*
+        The operation was accepted.
+        Upon completion, the NRF_FSTORAGE_ERASE_RESULT event is sent to the callback function
+        registered by the instance.
+
+        If error, try increasing NRF_FSTORAGE_SD_MAX_RETRIES and NRF_FSTORAGE_SD_QUEUE_SIZE.
+    */
+    while (!flag_erase_completed)
+    {
+        yield();  // Meanwhile execute tasks.
+    }
+
+    PROF_COMPLETION_ADD( EEPROM_LL_OP_ERASE, time_submitted );
+    PROF_STALL_ADD( EEPROM_LL_OP_ERASE, time_start );
+
+    return RESULT_OK;
+}
+
+#if EEPROM_LL_PROF_ENABLED
+const eeprom_ll_prof_t * eeprom_ll_prof_get( eeprom_ll_op_t op )
+{
+    ASSERT_DYGMA( op < EEPROM_LL_OP_COUNT, "Invalid EEPROM operation" );
+
+    return &prof[ op ];
+}
+
+void eeprom_ll_prof_reset( void )
+{
+    memset( prof, 0x00, sizeof( prof ) );
+}
+#endif
+
+#endif /* EEPROM_LL_HOST */
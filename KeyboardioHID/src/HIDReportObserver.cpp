@@ -24,5 +24,66 @@ THE SOFTWARE.
 */
 
 #include "HIDReportObserver.h"
+#include <Arduino.h>
 
 HIDReportObserver::SendReportHook HIDReportObserver::send_report_hook_ = nullptr;
+
+static_assert((HID_REPORT_TRACE_SIZE & (HID_REPORT_TRACE_SIZE - 1)) == 0,
+              "HID_REPORT_TRACE_SIZE must be a power of 2");
+
+// The reports are submitted from the main loop only, so there is a single
+// writer. It reserves the slot before writing into it, so a reader knows
+// whether its copy may have been overwritten meanwhile.
+static HIDReportTraceEntry trace_ring_[HID_REPORT_TRACE_SIZE];
+static uint32_t trace_head_ = 0;        // Sequence number of the next entry
+static uint32_t trace_reserved_ = 0;    // Sequence number of the entry after the one being written
+
+void HIDReportObserver::traceRecord(uint8_t id, const void* data, int len, int result) {
+  uint32_t head = __atomic_load_n(&trace_head_, __ATOMIC_RELAXED);
+  HIDReportTraceEntry *p_entry = &trace_ring_[head & (HID_REPORT_TRACE_SIZE - 1)];
+  uint8_t copy_len = (len < HID_REPORT_TRACE_DATA_LEN) ? len : HID_REPORT_TRACE_DATA_LEN;
+
+  __atomic_store_n(&trace_reserved_, head + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  p_entry->timestamp = micros();
+  p_entry->id = id;
+  p_entry->len = len;
+  p_entry->result = result;
+  memset(p_entry->data, 0, sizeof(p_entry->data));
+  memcpy(p_entry->data, data, copy_len);
+
+  __atomic_store_n(&trace_head_, head + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t HIDReportObserver::traceHead() {
+  return __atomic_load_n(&trace_head_, __ATOMIC_ACQUIRE);
+}
+
+bool HIDReportObserver::traceRead(uint32_t *p_cursor, HIDReportTraceEntry *p_entry,
+                                  uint32_t *p_lost) {
+  for (;;) {
+    uint32_t head = __atomic_load_n(&trace_head_, __ATOMIC_ACQUIRE);
+
+    if (*p_cursor == head) {
+      return false;
+    }
+
+    // Skip what has been overwritten already
+    if (head - *p_cursor > HID_REPORT_TRACE_SIZE) {
+      if (p_lost) {
+        *p_lost += head - *p_cursor - HID_REPORT_TRACE_SIZE;
+      }
+      *p_cursor = head - HID_REPORT_TRACE_SIZE;
+    }
+
+    *p_entry = trace_ring_[*p_cursor & (HID_REPORT_TRACE_SIZE - 1)];
+
+    // Keep the copy only if the writer did not start overwriting it meanwhile
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&trace_reserved_, __ATOMIC_RELAXED) - *p_cursor <= HID_REPORT_TRACE_SIZE) {
+      (*p_cursor)++;
+      return true;
+    }
+  }
+}
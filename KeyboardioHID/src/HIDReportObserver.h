@@ -27,6 +27,22 @@ THE SOFTWARE.
 
 #include <stdint.h>
 
+// Number of reports kept by the trace ring, a power of 2
+#ifndef HID_REPORT_TRACE_SIZE
+#define HID_REPORT_TRACE_SIZE 64
+#endif
+
+// Number of report bytes kept by each trace entry
+#define HID_REPORT_TRACE_DATA_LEN 8
+
+struct HIDReportTraceEntry {
+  uint32_t timestamp;   // micros() when the report was submitted
+  uint8_t id;
+  uint8_t len;
+  int16_t result;
+  uint8_t data[HID_REPORT_TRACE_DATA_LEN];
+};
+
 class HIDReportObserver {
  public:
 
@@ -35,6 +51,7 @@ class HIDReportObserver {
 
   static void observeReport(uint8_t id, const void* data,
                             int len, int result) {
+    traceRecord(id, data, len, result);
     if (send_report_hook_) {
       (*send_report_hook_)(id, data, len, result);
     }
@@ -50,7 +67,18 @@ class HIDReportObserver {
     return previous_hook;
   }
 
+  // The trace ring records every report submitted, without calling anyone.
+  // Each reader keeps its own cursor, starting from traceHead() to get the
+  // reports submitted from now on. A reader falling behind by more than the
+  // ring size loses the oldest entries, traceRead() skips them and adds their
+  // number to *p_lost when not NULL.
+  static uint32_t traceHead();
+  static bool traceRead(uint32_t *p_cursor, HIDReportTraceEntry *p_entry,
+                        uint32_t *p_lost = nullptr);
+
  private:
 
+  static void traceRecord(uint8_t id, const void* data, int len, int result);
+
   static SendReportHook send_report_hook_;
 };
@@ -97,15 +97,35 @@ void Mouse_::click(uint8_t b) {
   sendReport();
 }
 
+static void accumulateMotion(int16_t *acc, int8_t delta) {
+  int32_t sum = *acc + delta;
+  *acc = (int16_t)constrain(sum, INT16_MIN, INT16_MAX);
+}
+
+static int8_t peekMotion(int16_t acc) {
+  return (int8_t)constrain(acc, -127, 127);
+}
+
+static int8_t takeMotion(int16_t *acc) {
+  int8_t delta = peekMotion(*acc);
+  *acc -= delta;
+  return delta;
+}
+
 void Mouse_::move(int8_t x, int8_t y, int8_t v_wheel, int8_t h_wheel) {
-  report_.xAxis = x;
-  report_.yAxis = y;
-  report_.vWheel = v_wheel;
-  report_.hWheel = h_wheel;
+  // The moves add up until they are sent, so none is lost between two reports
+  accumulateMotion(&x_acc_, x);
+  accumulateMotion(&y_acc_, y);
+  accumulateMotion(&v_wheel_acc_, v_wheel);
+  accumulateMotion(&h_wheel_acc_, h_wheel);
 }
 
 void Mouse_::releaseAll() {
   memset(&report_, 0, sizeof(report_));
+  x_acc_ = 0;
+  y_acc_ = 0;
+  v_wheel_acc_ = 0;
+  h_wheel_acc_ = 0;
 }
 
 void Mouse_::press(uint8_t b) {
@@ -126,17 +146,47 @@ void Mouse_::sendReportUnchecked() {
   HID().SendReport(HID_REPORTID_MOUSE, &report_, sizeof(report_));
 }
 
+const HID_MouseReport_Data_t Mouse_::getReport() {
+  HID_MouseReport_Data_t report = report_;
+  report.xAxis = peekMotion(x_acc_);
+  report.yAxis = peekMotion(y_acc_);
+  report.vWheel = peekMotion(v_wheel_acc_);
+  report.hWheel = peekMotion(h_wheel_acc_);
+  return report;
+}
+
 void Mouse_::sendReport() {
+  bool moving = (x_acc_ != 0 || y_acc_ != 0 ||
+                 v_wheel_acc_ != 0 || h_wheel_acc_ != 0);
+
   // If the button state has not changed, and neither the cursor nor the wheel
   // is being told to move, there is no need to send a report.  This check
   // prevents us from sending lots of no-op reports if the caller is in a loop
   // and not checking or buggy.
-  if (report_.buttons != prev_report_buttons_ ||
-      report_.xAxis != 0 || report_.yAxis != 0 ||
-      report_.vWheel != 0 || report_.hWheel != 0) {
-    sendReportUnchecked();
-    prev_report_buttons_ = report_.buttons;
+  //
+  // The motion alone is sent only once the previous mouse report has left the
+  // transmit queue, so the reports follow the rate of the transport and the
+  // motion meanwhile adds up in the accumulators.
+  if (report_.buttons == prev_report_buttons_ &&
+      (!moving || HID().txPending(HID_REPORTID_MOUSE))) {
+    return;
   }
+
+  report_.xAxis = takeMotion(&x_acc_);
+  report_.yAxis = takeMotion(&y_acc_);
+  report_.vWheel = takeMotion(&v_wheel_acc_);
+  report_.hWheel = takeMotion(&h_wheel_acc_);
+  sendReportUnchecked();
+  prev_report_buttons_ = report_.buttons;
+}
+
+void Mouse_::sendMotionPending() {
+  // A button change goes with the sendReport() of its caller
+  if (report_.buttons != prev_report_buttons_) {
+    return;
+  }
+
+  sendReport();
 }
 
 Mouse_ Mouse;
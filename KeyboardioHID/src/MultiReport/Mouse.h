@@ -63,17 +63,27 @@ class Mouse_ {
    *
    * @returns A copy of the report.
    */
-  const HID_MouseReport_Data_t getReport() {
-    return report_;
-  }
+  const HID_MouseReport_Data_t getReport();
   void sendReport();
 
+  // Sends the motion left in the accumulators, if the buttons have not
+  // changed. HID().SendLastReport calls it when the mouse lane empties, so the
+  // leftover follows the rate of the transport without waiting for a new move.
+  void sendMotionPending();
+
   void releaseAll();
 
  protected:
   HID_MouseReport_Data_t report_;
   uint8_t prev_report_buttons_ = 0;
 
+  // The motion moved but not sent yet. Each report takes up to +-127 of it,
+  // the rest waits for the next one.
+  int16_t x_acc_ = 0;
+  int16_t y_acc_ = 0;
+  int16_t v_wheel_acc_ = 0;
+  int16_t h_wheel_acc_ = 0;
+
  private:
   void sendReportUnchecked();
 };
@@ -38,6 +38,8 @@ uint8_t tx_ff_buf[INPUT_REPORT_LEN_RAW*50];//Up to 50 messages
 
 RawHID_ RawHID;
 
+static RawHID_Stats_t raw_hid_stats;
+
 
 int RawHID_::peek(void)
 {
@@ -59,18 +61,24 @@ size_t RawHID_::read(uint8_t *buffer, size_t size)
 void RawHID_::flush(void)
 {
     if(!ble_connected()) return;
-    uint16_t size = tu_fifo_count(&tx_ff);
-    if (size ==0) return;
-    uint8_t buff[INPUT_REPORT_LEN_RAW];
-    memset(buff,0,INPUT_REPORT_LEN_RAW);
-    uint16_t i = tu_fifo_peek_n(&tx_ff, buff, INPUT_REPORT_LEN_RAW);
-    if (i != 0)
+
+    //Stream the reports back to back, until the BLE stack has no free buffer for the coming connection events
+    for (uint8_t n = 0; n < RAW_HID_TX_FLUSH_MAX; n++)
     {
-        if (ble_send_report(HID_REPORTID_RAWHID, buff, INPUT_REPORT_LEN_RAW)){
-            tu_fifo_advance_read_pointer(&tx_ff, i);
+        if(HID().txPending()) return; //The keyboard, control and mouse reports go first
+        uint16_t size = tu_fifo_count(&tx_ff);
+        if (size ==0) return;
+        uint8_t buff[INPUT_REPORT_LEN_RAW];
+        memset(buff,0,INPUT_REPORT_LEN_RAW);
+        uint16_t i = tu_fifo_peek_n(&tx_ff, buff, INPUT_REPORT_LEN_RAW);
+        if (!ble_send_report(HID_REPORTID_RAWHID, buff, INPUT_REPORT_LEN_RAW)){
+            raw_hid_stats.tx_busy++;
+            return;
         }
+        tu_fifo_advance_read_pointer(&tx_ff, i);
+        raw_hid_stats.tx_reports++;
+        raw_hid_stats.tx_bytes += i;
     }
-    //Send report each time
 }
 
 size_t RawHID_::write(uint8_t ch)
@@ -81,12 +89,21 @@ size_t RawHID_::write(uint8_t ch)
 size_t RawHID_::write(const uint8_t *buffer, size_t size)
 {
     if(!ble_connected()) return 0;
-    return tu_fifo_write_n(&tx_ff, buffer, size);
+    //Only what fits is taken, the writers check the returned size or availableForWrite()
+    uint16_t written = tu_fifo_write_n(&tx_ff, buffer, size);
+    raw_hid_stats.tx_dropped += size - written;
+    return written;
 }
 
 int RawHID_::availableForWrite(void)
 {
-    return ble_connected();
+    if(!ble_connected()) return 0;
+    return tu_fifo_remaining(&tx_ff);
+}
+
+void RawHID_::statsGet(RawHID_Stats_t *p_stats)
+{
+    *p_stats = raw_hid_stats;
 }
 
 RawHID_::~RawHID_()
@@ -101,7 +118,7 @@ int RawHID_::available(void)
 void RawHID_::begin()
 {
     tu_fifo_config(&rx_ff, rx_ff_buf, TU_ARRAY_SIZE(rx_ff_buf), 1, false);
-    tu_fifo_config(&tx_ff, tx_ff_buf, TU_ARRAY_SIZE(tx_ff_buf), 1, true);
+    tu_fifo_config(&tx_ff, tx_ff_buf, TU_ARRAY_SIZE(tx_ff_buf), 1, false);
 }
 
 
@@ -125,8 +142,31 @@ extern "C"
 
     bool callBackRawHID(uint8_t *buff)
     {
-        size_t size = strnlen_s((char *)buff, OUTPUT_REPORT_LEN_RAW);
-        tu_fifo_write_n(&rx_ff, buff, (uint16_t) size);
+        const uint8_t *data = buff;
+        size_t size;
+
+        if (buff[0] == RAW_HID_RX_FRAME_MARKER)
+        {
+            //Length framed report, binary safe
+            size = buff[1] | ((size_t)buff[2] << 8);
+            data = &buff[RAW_HID_RX_FRAME_HEADER_LEN];
+            if (size > OUTPUT_REPORT_LEN_RAW - RAW_HID_RX_FRAME_HEADER_LEN) {
+                return false;
+            }
+        }
+        else
+        {
+            //Text report, padded with zeros
+            size = strnlen_s((char *)buff, OUTPUT_REPORT_LEN_RAW);
+        }
+
+        //A report is stored entirely or not at all, a partial one would corrupt the stream
+        if (tu_fifo_remaining(&rx_ff) < size) {
+            raw_hid_stats.rx_dropped++;
+            return false;
+        }
+
+        tu_fifo_write_n(&rx_ff, data, (uint16_t) size);
         return false;
     }
 }
@@ -9,6 +9,27 @@
 
 #include "Stream.h"
 
+/*
+ * The received raw HID reports are either text, padded with zeros, or length framed. A framed report starts with
+ * the marker, followed by the payload length ( 16 bits, little endian ) and the payload, which may hold any byte.
+ * The marker never starts a UTF-8 text.
+ */
+#define RAW_HID_RX_FRAME_MARKER      0xFF
+#define RAW_HID_RX_FRAME_HEADER_LEN  3
+
+//Maximum number of reports sent by one flush call
+#ifndef RAW_HID_TX_FLUSH_MAX
+#define RAW_HID_TX_FLUSH_MAX         16
+#endif
+
+typedef struct {
+  uint32_t tx_bytes;
+  uint32_t tx_reports;
+  uint32_t tx_busy;       //Flushes stopped by the BLE stack buffers being full
+  uint32_t tx_dropped;    //Bytes refused by write, tx_ff was full
+  uint32_t rx_dropped;    //Reports refused, rx_ff was full
+} RawHID_Stats_t;
+
 class RawHID_ : public Stream {
 public:
   RawHID_(void){};
@@ -31,6 +52,7 @@ public:
   }
 
   virtual int availableForWrite(void);
+  void statsGet(RawHID_Stats_t *p_stats);
   using Print::write; // pull in write(str) from Print
 
 };
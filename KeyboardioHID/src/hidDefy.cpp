@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "HIDAliases.h"
 #include "HIDReportObserver.h"
 #include "MultiReport/Keyboard.h"
+#include "MultiReport/Mouse.h"
 #include "ble_hid_service.h"
 
 /*
@@ -37,6 +38,9 @@ THE SOFTWARE.
  */
 extern void hid_report_descriptor_usb_get( const uint8_t ** pp_desc, uint32_t * p_desc_len );
 extern void hid_report_descriptor_ble_get( const uint8_t ** pp_desc, uint32_t * p_desc_len );
+#if HID_USB_SPLIT_ENDPOINTS
+extern void hid_report_descriptor_usb_keyboard_get( const uint8_t ** pp_desc, uint32_t * p_desc_len );
+#endif
 
 HID_ &HID()
 {
@@ -60,16 +64,375 @@ int HID_::SendReport(uint8_t id, const void *data, int len)
 }
 
 
-tu_fifo_t tx_ff_hid;
+/*
+ * Transmit queue. A ring of fixed size slots, each one holding a whole report. A report is either queued entirely
+ * or not at all, so the reader never loses the framing. When the queue is full, the HID_TX_QUEUE_DROP_OLDEST policy
+ * decides which report is dropped, the reports kept are always complete.
+ *
+ * There is one queue per lane, and the lanes are served in strict priority: the keyboard first, then the consumer
+ * and system control, then the mouse. So a burst of mouse motion never delays a key press. The raw HID reports are
+ * sent by RawHID only when all the lanes are empty. The order is kept within a lane only.
+ */
 
-uint8_t tx_ff_buf_hid[8000];
+#define HID_TX_REPORT_LEN_MAX   64
 
-struct NextReport
+typedef struct
 {
     uint8_t id;
-    uint16_t len;
+    uint8_t len;
+    uint8_t data[HID_TX_REPORT_LEN_MAX];
+#if HID_TX_LATENCY_ENABLED
+    bool traced;
+    uint32_t t_event;
+    uint32_t t_queued;
+#endif
+} tx_report_t;
+
+typedef struct
+{
+    tx_report_t *p_slot;
+    uint16_t size;
+    uint16_t head;
+    uint16_t count;
+#if HID_TX_COALESCE_ENABLED
+    uint8_t tail_base[HID_TX_REPORT_LEN_MAX];       /* The state of the same report ID preceding the queue tail */
+#endif
+} tx_queue_t;
+
+typedef enum
+{
+    TX_LANE_KEYBOARD = 0,
+    TX_LANE_CONTROL,
+    TX_LANE_MOUSE,
+
+    TX_LANE_COUNT,
+} tx_lane_t;        /* In the priority order */
+
+static tx_report_t tx_slot_keyboard[HID_TX_QUEUE_KEYBOARD_SIZE];
+static tx_report_t tx_slot_control[HID_TX_QUEUE_CONTROL_SIZE];
+static tx_report_t tx_slot_mouse[HID_TX_QUEUE_MOUSE_SIZE];
+
+static tx_queue_t tx_lane[TX_LANE_COUNT] =
+{
+    { tx_slot_keyboard, TU_ARRAY_SIZE(tx_slot_keyboard) },     /* TX_LANE_KEYBOARD */
+    { tx_slot_control, TU_ARRAY_SIZE(tx_slot_control) },       /* TX_LANE_CONTROL */
+    { tx_slot_mouse, TU_ARRAY_SIZE(tx_slot_mouse) },           /* TX_LANE_MOUSE */
 };
 
+static HID_TxStats_t tx_stats;
+
+static HID_TxProfileHook tx_profile_hook = NULL;
+
+static tx_queue_t *tx_lane_get(uint8_t id)
+{
+    switch (id)
+    {
+        case HID_REPORTID_NKRO_KEYBOARD:
+
+            return &tx_lane[TX_LANE_KEYBOARD];
+
+        case HID_REPORTID_MOUSE:
+
+            return &tx_lane[TX_LANE_MOUSE];
+
+        default:
+
+            return &tx_lane[TX_LANE_CONTROL];
+    }
+}
+
+static uint16_t tx_depth_get(void)
+{
+    uint16_t depth = 0;
+
+    for (uint8_t i = 0; i < TX_LANE_COUNT; i++)
+    {
+        depth += tx_lane[i].count;
+    }
+
+    return depth;
+}
+
+static tx_queue_t *tx_next_get(uint8_t lane_first)
+{
+    for (uint8_t i = lane_first; i < TX_LANE_COUNT; i++)
+    {
+        if (tx_lane[i].count != 0)
+        {
+            return &tx_lane[i];
+        }
+    }
+
+    return NULL;
+}
+
+static tx_report_t *tx_queue_peek(tx_queue_t *p_queue)
+{
+    return (p_queue->count == 0) ? NULL : &p_queue->p_slot[p_queue->head];
+}
+
+static tx_report_t *tx_queue_tail(tx_queue_t *p_queue)
+{
+    return (p_queue->count == 0) ? NULL : &p_queue->p_slot[(p_queue->head + p_queue->count - 1) % p_queue->size];
+}
+
+static void tx_queue_pop(tx_queue_t *p_queue)
+{
+    if (p_queue->count == 0)
+    {
+        return;
+    }
+
+    p_queue->head = (p_queue->head + 1) % p_queue->size;
+    p_queue->count--;
+}
+
+static tx_report_t *tx_queue_push(tx_queue_t *p_queue)
+{
+    uint16_t depth;
+
+    if (p_queue->count == p_queue->size)
+    {
+        tx_stats.dropped++;
+
+#if HID_TX_QUEUE_DROP_OLDEST
+        tx_queue_pop(p_queue);
+#else
+        return NULL;
+#endif
+    }
+
+    p_queue->count++;
+
+    tx_stats.queued++;
+    depth = tx_depth_get();
+    if (depth > tx_stats.depth_max)
+    {
+        tx_stats.depth_max = depth;
+    }
+
+    return tx_queue_tail(p_queue);
+}
+
+#if HID_TX_COALESCE_ENABLED
+/*
+ * Report coalescing. While a report waits in the transmit queue, the next report with the same ID is merged into it
+ * when no transition is lost by that:
+ *
+ * - The keyboard and the mouse buttons are bitmaps. The host orders the presses of a single report by their usage,
+ *   so every new press gets its own report. The merge is allowed only if the new report repeats the queued one, or
+ *   the queued one adds no press over the state preceding it and the new one only releases more keys. So no
+ *   transition is reverted and the presses reach the host in their order ( e.g. B then A is not sent as { A, B } and
+ *   a shift pressed after a letter does not apply to it ).
+ * - The mouse motion is relative, so the deltas are summed as long as they fit.
+ * - The consumer and system control reports are usage arrays, only the repeated reports are merged.
+ *
+ * Only the queue tail is merged into, so the order between the report IDs is kept.
+ */
+
+static struct
+{
+    uint16_t len;
+    uint8_t data[HID_TX_REPORT_LEN_MAX];
+} tx_last_state[HID_REPORTID_SYSTEMCONTROL + 1];      /* The last queued state of each report ID */
+
+static bool tx_coalesce_bitmap_check(const uint8_t *base, const uint8_t *held, const uint8_t *data, uint16_t len)
+{
+    bool repeating = true;
+    bool releasing = true;
+
+    /* Either the same state again, or the held state adds no press over the base and the new state no press over it */
+    for (uint16_t i = 0; i < len; i++)
+    {
+        repeating = repeating && (held[i] == data[i]);
+        releasing = releasing && ((held[i] & ~base[i]) == 0) && ((data[i] & ~held[i]) == 0);
+    }
+
+    return repeating || releasing;
+}
+
+static bool tx_coalesce_merge(tx_queue_t *p_queue, uint8_t id, const uint8_t *data, uint16_t len)
+{
+    tx_report_t *p_tail = tx_queue_tail(p_queue);
+
+    if (p_tail == NULL || p_tail->id != id || p_tail->len != len)
+    {
+        return false;
+    }
+
+    switch (id)
+    {
+        case HID_REPORTID_NKRO_KEYBOARD:
+
+            if (!tx_coalesce_bitmap_check(p_queue->tail_base, p_tail->data, data, len))
+            {
+                return false;
+            }
+
+            memcpy(p_tail->data, data, len);
+
+            return true;
+
+        case HID_REPORTID_MOUSE:
+        {
+            const HID_MouseReport_Data_t *p_new = (const HID_MouseReport_Data_t *)data;
+            HID_MouseReport_Data_t *p_held = (HID_MouseReport_Data_t *)p_tail->data;
+            int16_t axis[4] = { (int16_t)(p_held->xAxis + p_new->xAxis), (int16_t)(p_held->yAxis + p_new->yAxis),
+                                (int16_t)(p_held->vWheel + p_new->vWheel), (int16_t)(p_held->hWheel + p_new->hWheel) };
+
+            if (!tx_coalesce_bitmap_check(p_queue->tail_base, &p_held->buttons, &p_new->buttons, sizeof(p_new->buttons)))
+            {
+                return false;
+            }
+
+            for (uint8_t i = 0; i < 4; i++)
+            {
+                if (axis[i] < -127 || axis[i] > 127)
+                {
+                    return false;
+                }
+            }
+
+            p_held->buttons = p_new->buttons;
+            p_held->xAxis = (int8_t)axis[0];
+            p_held->yAxis = (int8_t)axis[1];
+            p_held->vWheel = (int8_t)axis[2];
+            p_held->hWheel = (int8_t)axis[3];
+
+            return true;
+        }
+
+        case HID_REPORTID_CONSUMERCONTROL:
+        case HID_REPORTID_SYSTEMCONTROL:
+
+            return (memcmp(p_tail->data, data, len) == 0);
+
+        default:
+
+            return false;
+    }
+}
+
+static void tx_coalesce_base_set(tx_queue_t *p_queue, uint8_t id, uint16_t len)
+{
+    /* The state preceding the new tail, the reports before the first one of the ID are considered all released */
+    memset(p_queue->tail_base, 0x00, len);
+    if (id < TU_ARRAY_SIZE(tx_last_state) && tx_last_state[id].len == len)
+    {
+        memcpy(p_queue->tail_base, tx_last_state[id].data, len);
+    }
+}
+
+static void tx_last_state_set(uint8_t id, const uint8_t *data, uint16_t len)
+{
+    if (id >= TU_ARRAY_SIZE(tx_last_state))
+    {
+        return;
+    }
+
+    tx_last_state[id].len = len;
+    memcpy(tx_last_state[id].data, data, len);
+}
+#endif
+
+#if HID_TX_LATENCY_ENABLED
+/*
+ * Latency trace. The time of the oldest key event not reported yet is carried by the next keyboard report queued,
+ * or merged, together with the time it was queued. Once that report is sent, the hook gets the three times.
+ */
+
+static struct
+{
+    HID_TxLatencyClock clock;
+    HID_TxLatencyHook hook;
+    bool event_pending;
+    uint32_t t_event;
+} tx_latency;
+
+static bool tx_latency_event_stale(void)
+{
+    return (tx_latency.clock() - tx_latency.t_event) > HID_TX_LATENCY_EVENT_TIMEOUT_US;
+}
+
+static void tx_latency_stamp(tx_report_t *p_report)
+{
+    if (tx_latency.clock == NULL || !tx_latency.event_pending || p_report->id != HID_REPORTID_NKRO_KEYBOARD)
+    {
+        return;
+    }
+
+    if (p_report->traced || tx_latency_event_stale())
+    {
+        /* Merged into a report already carrying an older event, or too old to be the cause of this report */
+        tx_latency.event_pending = false;
+        return;
+    }
+
+    p_report->traced = true;
+    p_report->t_event = tx_latency.t_event;
+    p_report->t_queued = tx_latency.clock();
+    tx_latency.event_pending = false;
+}
+
+static void tx_latency_sent(const tx_report_t *p_report, bool ble)
+{
+    if (tx_latency.hook == NULL || !p_report->traced)
+    {
+        return;
+    }
+
+    tx_latency.hook(ble, p_report->t_event, p_report->t_queued, tx_latency.clock());
+}
+#endif
+
+static void tx_report_queue(uint8_t id, const void *data, uint16_t len)
+{
+    tx_queue_t *p_queue = tx_lane_get(id);
+    tx_report_t *p_report;
+
+    if (len > HID_TX_REPORT_LEN_MAX)
+    {
+        /* Does not fit any slot */
+        tx_stats.dropped++;
+        return;
+    }
+
+#if HID_TX_COALESCE_ENABLED
+    if (tx_coalesce_merge(p_queue, id, (const uint8_t *)data, len))
+    {
+        tx_stats.merged++;
+
+#if HID_TX_LATENCY_ENABLED
+        tx_latency_stamp(tx_queue_tail(p_queue));
+#endif
+
+        /* The merged mouse report is not the last state, but only its buttons are used as the base */
+        tx_last_state_set(id, (const uint8_t *)data, len);
+        return;
+    }
+#endif
+
+    p_report = tx_queue_push(p_queue);
+    if (p_report == NULL)
+    {
+        return;
+    }
+
+    p_report->id = id;
+    p_report->len = (uint8_t)len;
+    memcpy(p_report->data, data, len);
+
+#if HID_TX_LATENCY_ENABLED
+    p_report->traced = false;
+    tx_latency_stamp(p_report);
+#endif
+
+#if HID_TX_COALESCE_ENABLED
+    tx_coalesce_base_set(p_queue, id, len);
+    tx_last_state_set(id, (const uint8_t *)data, len);
+#endif
+}
+
 int HID_::SendReport_(uint8_t id, const void *data, int len)
 {
     /* On SAMD, we need to send the whole report in one batch; sending the id, and
@@ -106,9 +469,7 @@ int HID_::SendReport_(uint8_t id, const void *data, int len)
     }
     else if (TinyUSBDevice.mounted() || ble_connected())
     {
-        NextReport nextReport{id, static_cast<uint16_t>(len)};
-        tu_fifo_write_n(&tx_ff_hid, &nextReport, (uint16_t)(sizeof(nextReport)));
-        tu_fifo_write_n(&tx_ff_hid, data, (uint16_t)len);
+        tx_report_queue(id, data, (uint16_t)len);
     }
 
     return 1;
@@ -122,29 +483,134 @@ int HID_::SendReport_(uint8_t id, const void *data, int len)
 bool HID_::SendLastReport()
 {
     bool success = true;
-    if (tu_fifo_count(&tx_ff_hid) != 0)
+    bool ble;
+    uint8_t lane_first = TX_LANE_KEYBOARD;
+    tx_queue_t *p_queue;
+    tx_report_t *p_report;
+
+    if (tx_profile_hook != NULL)
+    {
+        tx_profile_hook(true);
+    }
+
+    /*
+     * Send as many reports as the transport accepts now. The BLE stack takes several notifications for the next
+     * connection event and refuses the rest until its buffers are released, the USB endpoint takes one per poll
+     * interval. The first refused report stays queued for the next call.
+     */
+    for (uint8_t i = 0; i < HID_TX_DRAIN_MAX; i++)
     {
-        struct
+        p_queue = tx_next_get(lane_first);
+        if (p_queue == NULL)
         {
-            NextReport nextReport;
-            uint8_t dataReport[256];
-        } nextReportWithData;
-        tu_fifo_peek_n(&tx_ff_hid, &nextReportWithData.nextReport, (uint16_t)(sizeof(nextReportWithData.nextReport)));
-        tu_fifo_peek_n(&tx_ff_hid, &nextReportWithData, (uint16_t)(sizeof(nextReportWithData.nextReport)) + nextReportWithData.nextReport.len);
-
-        if (ble_connected())
-            success = ble_send_report(nextReportWithData.nextReport.id, (uint8_t *const)nextReportWithData.dataReport, nextReportWithData.nextReport.len);
+            break;
+        }
+
+        p_report = tx_queue_peek(p_queue);
+
+        ble = ble_connected();
+        if (ble)
+            success = ble_send_report(p_report->id, (uint8_t *const)p_report->data, p_report->len);
         else
-            success = usb_hid.sendReport(nextReportWithData.nextReport.id, nextReportWithData.dataReport, nextReportWithData.nextReport.len);
+            success = usb_hid_get(p_report->id)->sendReport(p_report->id, p_report->data, p_report->len);
+
+#if HID_TX_LATENCY_ENABLED
+        if (success)
+        {
+            tx_latency_sent(p_report, ble);
+        }
+#endif
 
         if (success || (ble_innited() && !ble_connected()) || (!ble_innited() && TinyUSBDevice.suspended()))
         {
-            tu_fifo_advance_read_pointer(&tx_ff_hid, (uint16_t)(sizeof(nextReportWithData.nextReport)) + nextReportWithData.nextReport.len);
+            tx_queue_pop(p_queue);
+
+            /* The motion added up meanwhile goes once the mouse lane is empty, still within this call */
+            if (p_queue == &tx_lane[TX_LANE_MOUSE] && p_queue->count == 0)
+            {
+                Mouse.sendMotionPending();
+            }
+        }
+
+        if (!success)
+        {
+#if HID_USB_SPLIT_ENDPOINTS
+            /* Only the USB keyboard endpoint is busy, the other lanes go through their own */
+            if (!ble_innited() && !TinyUSBDevice.suspended() && p_queue == &tx_lane[TX_LANE_KEYBOARD])
+            {
+                lane_first = TX_LANE_CONTROL;
+                continue;
+            }
+#endif
+            break;
         }
     }
+
+    if (tx_profile_hook != NULL)
+    {
+        tx_profile_hook(false);
+    }
+
     return success;
 }
 
+Adafruit_USBD_HID *HID_::usb_hid_get(uint8_t id)
+{
+#if HID_USB_SPLIT_ENDPOINTS
+    if (id == HID_REPORTID_NKRO_KEYBOARD)
+    {
+        return &usb_hid_keyboard;
+    }
+#endif
+
+    return &usb_hid;
+}
+
+void HID_::txStatsGet(HID_TxStats_t *p_stats)
+{
+    *p_stats = tx_stats;
+    p_stats->depth = tx_depth_get();
+}
+
+bool HID_::txPending()
+{
+    return (tx_next_get(TX_LANE_KEYBOARD) != NULL);
+}
+
+bool HID_::txPending(uint8_t id)
+{
+    return (tx_lane_get(id)->count != 0);
+}
+
+void HID_::txLatencyTraceSet(HID_TxLatencyClock clock, HID_TxLatencyHook hook)
+{
+#if HID_TX_LATENCY_ENABLED
+    tx_latency.event_pending = false;
+    tx_latency.clock = clock;
+    tx_latency.hook = hook;
+#else
+    (void)clock;
+    (void)hook;
+#endif
+}
+
+void HID_::txLatencyEventMark()
+{
+#if HID_TX_LATENCY_ENABLED
+    /* Keep the oldest event, the next keyboard report is the first one that may carry it. A stale one gives way */
+    if (tx_latency.clock != NULL && (!tx_latency.event_pending || tx_latency_event_stale()))
+    {
+        tx_latency.event_pending = true;
+        tx_latency.t_event = tx_latency.clock();
+    }
+#endif
+}
+
+void HID_::txProfileHookSet(HID_TxProfileHook hook)
+{
+    tx_profile_hook = hook;
+}
+
 HID_::HID_() : protocol(HID_REPORT_PROTOCOL), idle(0)
 {
     setReportData.reportId = 0;
@@ -156,6 +622,16 @@ int HID_::begin()
     const uint8_t * p_descriptor;
     uint32_t descriptor_len;
 
+#if HID_USB_SPLIT_ENDPOINTS
+    /* Set the USB HID report descriptor of the keyboard interface */
+    hid_report_descriptor_usb_keyboard_get( &p_descriptor, &descriptor_len );
+
+    usb_hid_keyboard.setPollInterval(1);
+    usb_hid_keyboard.setReportDescriptor(p_descriptor, descriptor_len);
+    usb_hid_keyboard.setBootProtocol(0);
+    usb_hid_keyboard.begin();
+#endif
+
     /* Set the USB HID report descriptor */
     hid_report_descriptor_usb_get( &p_descriptor, &descriptor_len );
 
@@ -163,7 +639,6 @@ int HID_::begin()
     usb_hid.setReportDescriptor(p_descriptor, descriptor_len);
     usb_hid.setBootProtocol(0);
     usb_hid.begin();
-    tu_fifo_config(&tx_ff_hid, tx_ff_buf_hid, TU_ARRAY_SIZE(tx_ff_buf_hid), 1, true);
 
     /* Set the BLE HID report descriptor */
     hid_report_descriptor_ble_get( &p_descriptor, &descriptor_len );
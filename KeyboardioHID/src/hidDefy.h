@@ -38,6 +38,53 @@ THE SOFTWARE.
 
 #define _USING_HID
 
+/* Number of report slots in the transmit queue of each lane, see hidDefy.cpp */
+#ifndef HID_TX_QUEUE_KEYBOARD_SIZE
+#define HID_TX_QUEUE_KEYBOARD_SIZE  48
+#endif
+
+#ifndef HID_TX_QUEUE_CONTROL_SIZE
+#define HID_TX_QUEUE_CONTROL_SIZE   8
+#endif
+
+#ifndef HID_TX_QUEUE_MOUSE_SIZE
+#define HID_TX_QUEUE_MOUSE_SIZE     8
+#endif
+
+/* Queue full policy, drop the oldest report ( 1 ) so the latest state reaches the host, or the new one ( 0 ) */
+#ifndef HID_TX_QUEUE_DROP_OLDEST
+#define HID_TX_QUEUE_DROP_OLDEST    1
+#endif
+
+/* Maximum number of reports sent by one SendLastReport call, it bounds the time spent there */
+#ifndef HID_TX_DRAIN_MAX
+#define HID_TX_DRAIN_MAX            8
+#endif
+
+/* Carry the time of the key events with the keyboard reports, see txLatencyTraceSet() */
+#ifndef HID_TX_LATENCY_ENABLED
+#define HID_TX_LATENCY_ENABLED      0
+#endif
+
+/* A key event not carried by a keyboard report within this time changed no report ( e.g. a layer key ) and is dropped */
+#ifndef HID_TX_LATENCY_EVENT_TIMEOUT_US
+#define HID_TX_LATENCY_EVENT_TIMEOUT_US     100000
+#endif
+
+/*
+ * Give the NKRO keyboard its own USB HID interface and interrupt IN endpoint, so the other reports never hold it up.
+ * The application then provides hid_report_descriptor_usb_keyboard_get() with HID_DEFY_REPORT_DESCRIPTOR_KEYBOARD,
+ * and hid_report_descriptor_usb_get() with HID_DEFY_REPORT_DESCRIPTOR_OTHER.
+ */
+#ifndef HID_USB_SPLIT_ENDPOINTS
+#define HID_USB_SPLIT_ENDPOINTS     0
+#endif
+
+/* Merge the consecutive reports of the same ID waiting in the transmit queue, see hidDefy.cpp */
+#ifndef HID_TX_COALESCE_ENABLED
+#define HID_TX_COALESCE_ENABLED     1
+#endif
+
 // HID 'Driver'
 // ------------
 #define HID_GET_REPORT        0x01
@@ -106,6 +153,22 @@ enum
 
 #endif
 
+typedef struct
+{
+    uint32_t queued;            /* Reports put in the transmit queue */
+    uint32_t merged;            /* Reports merged into the queue tail */
+    uint32_t dropped;           /* Reports dropped because the queue was full */
+    uint16_t depth;             /* Reports currently waiting */
+    uint16_t depth_max;
+} HID_TxStats_t;
+
+/* The latency trace clock, in us, and the hook called when a keyboard report carrying a key event has been sent */
+typedef uint32_t (*HID_TxLatencyClock)(void);
+typedef void (*HID_TxLatencyHook)(bool ble, uint32_t t_event, uint32_t t_queued, uint32_t t_sent);
+
+/* The profiler hook, called at the start ( begin true ) and at the end of each SendLastReport call */
+typedef void (*HID_TxProfileHook)(bool begin);
+
 class HID_ {
  public:
 
@@ -121,10 +184,21 @@ class HID_ {
     return setReportData.leds;
   };
 
+  void txStatsGet(HID_TxStats_t *p_stats);
+  bool txPending();
+  bool txPending(uint8_t id);
+  void txLatencyTraceSet(HID_TxLatencyClock clock, HID_TxLatencyHook hook);
+  void txLatencyEventMark();
+  void txProfileHookSet(HID_TxProfileHook hook);
+
   uint8_t getShortName(char *name);
   int SendReport_(uint8_t id, const void* data, int len);
   Adafruit_USBD_HID usb_hid;
+#if HID_USB_SPLIT_ENDPOINTS
+  Adafruit_USBD_HID usb_hid_keyboard;
+#endif
 private:
+  Adafruit_USBD_HID *usb_hid_get(uint8_t id);
   char keyboarName[20] = "Defy RP2040";
 //  std::vector<uint8_t> descriptor;
 
@@ -197,7 +271,7 @@ HID_COLLECTION_END                            \
 #define KEYBITS_PADDING
 #endif
 
-#define HID_DEFY_REPORT_DESCRIPTOR( usage_raw ) {                                                                                           \
+#define HID_DEFY_REPORT_DESC_KEYBOARD                                                                                                           \
     D_USAGE_PAGE, D_PAGE_GENERIC_DESKTOP, D_USAGE, D_USAGE_KEYBOARD, D_COLLECTION, D_APPLICATION, D_REPORT_ID, HID_REPORTID_NKRO_KEYBOARD,      \
     D_USAGE_PAGE, D_PAGE_KEYBOARD,                                                                                                              \
                                                                                                                                                 \
@@ -223,12 +297,18 @@ HID_COLLECTION_END                            \
     /* Padding to round up the report to byte boundary. */                                                                                      \
     KEYBITS_PADDING                                                                                                                             \
                                                                                                                                                 \
-    D_END_COLLECTION,                                                                                                                           \
-                                                                                                                                                \
+    D_END_COLLECTION
+
+#define HID_DEFY_REPORT_DESC_OTHER( usage_raw )                                                                                                 \
     TUD_HID_REPORT_DESC_MOUSE(HID_REPORT_ID(REPORT_ID_MOUSE)),                                                                                  \
     TUD_HID_REPORT_DESC_CONSUMER_DYGMA(HID_REPORT_ID(REPORT_ID_CONSUMER_CONTROL)),                                                              \
     TUD_HID_REPORT_DESC_SYSTEM_CONTROL(HID_REPORT_ID(REPORT_ID_SYSTEM_CONTROL)),                                                                \
-    TUD_HID_REPORT_DESC_GENERIC_INOUT_DYGMA(OUTPUT_REPORT_LEN_RAW, usage_raw, HID_REPORT_ID(REPORT_ID_RAW))                                                      \
-}
+    TUD_HID_REPORT_DESC_GENERIC_INOUT_DYGMA(OUTPUT_REPORT_LEN_RAW, usage_raw, HID_REPORT_ID(REPORT_ID_RAW))
+
+#define HID_DEFY_REPORT_DESCRIPTOR( usage_raw ) { HID_DEFY_REPORT_DESC_KEYBOARD, HID_DEFY_REPORT_DESC_OTHER( usage_raw ) }
+
+/* The descriptors of the two USB HID interfaces, see HID_USB_SPLIT_ENDPOINTS */
+#define HID_DEFY_REPORT_DESCRIPTOR_KEYBOARD { HID_DEFY_REPORT_DESC_KEYBOARD }
+#define HID_DEFY_REPORT_DESCRIPTOR_OTHER( usage_raw ) { HID_DEFY_REPORT_DESC_OTHER( usage_raw ) }
 
 #endif // HID_h
@@ -0,0 +1,174 @@
+/* -*- mode: c++ -*-
+ * Latency_trace -- Key to host latency of the keyboard reports
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Latency_trace.h"
+#include "Kaleidoscope-FocusSerial.h"
+
+#include "kbd_if_manager.h"
+#include "hidDefy.h"
+#include "HIDReportObserver.h"
+#include "Time_counter.h"
+
+result_t LatencyTrace::init( void )
+{
+    result_t result = RESULT_ERR;
+
+    stats_reset();
+
+    result = kbdif_initialize();
+    EXIT_IF_ERR( result, "kbdif_initialize failed" );
+
+    HID().txLatencyTraceSet( clock_get, report_sent_cb );
+
+    report_cursor = HIDReportObserver::traceHead();
+
+_EXIT:
+    return result;
+}
+
+void LatencyTrace::key_in( void )
+{
+    HID().txLatencyEventMark();
+}
+
+void LatencyTrace::stats_reset( void )
+{
+    for ( uint8_t transport = 0; transport < TRANSPORT_COUNT; transport++ )
+    {
+        dl_stats_reset( &stats[ transport ].process );
+        dl_stats_reset( &stats[ transport ].transmit );
+        dl_stats_reset( &stats[ transport ].total );
+    }
+}
+
+void LatencyTrace::reports_dump( void )
+{
+    HIDReportTraceEntry entry;
+    uint32_t lost = 0;
+
+    /* Each report as its time in us, ID, length, result and first bytes */
+    while ( HIDReportObserver::traceRead( &report_cursor, &entry, &lost ) )
+    {
+        ::Focus.send( entry.timestamp, entry.id, entry.len, entry.result );
+
+        for ( uint8_t i = 0; i < HID_REPORT_TRACE_DATA_LEN; i++ )
+        {
+            ::Focus.send( entry.data[ i ] );
+        }
+    }
+
+    /* Then the number of reports lost because the dump came too late */
+    ::Focus.send( lost );
+}
+
+uint32_t LatencyTrace::clock_get( void )
+{
+    /* The differences are taken in 32 bits, which is fine as long as no report waits for more than an hour */
+    return (uint32_t)timer_counter_get_micros();
+}
+
+void LatencyTrace::report_sent_cb( bool ble, uint32_t t_event, uint32_t t_queued, uint32_t t_sent )
+{
+    stats_t * p_stats = &::LatencyTrace.stats[ ble ? TRANSPORT_BLE : TRANSPORT_USB ];
+
+    dl_stats_add( &p_stats->process, t_queued - t_event );
+    dl_stats_add( &p_stats->transmit, t_sent - t_queued );
+    dl_stats_add( &p_stats->total, t_sent - t_event );
+}
+
+result_t LatencyTrace::kbdif_initialize()
+{
+    result_t result = RESULT_ERR;
+    kbdif_conf_t config;
+
+    /* Prepare the kbdif configuration */
+    config.p_instance = this;
+    config.handlers = &kbdif_handlers;
+
+    /* Initialize the kbdif */
+    result = kbdif_init( &p_kbdif, &config );
+    EXIT_IF_ERR( result, "kbdif_init failed" );
+
+    /* Add the kbdif into the kbdif manager */
+    result = kbdifmgr_add( p_kbdif );
+    EXIT_IF_ERR( result, "kbdifmgr_add failed" );
+
+_EXIT:
+    return result;
+}
+
+kbdapi_event_result_t LatencyTrace::kbdif_command_event_cb( void * p_instance, const char * p_command )
+{
+    class LatencyTrace * p_trace = ( class LatencyTrace * )p_instance;
+
+    if (::Focus.handleHelp(p_command, "debug.latency\ndebug.latency.histogram\ndebug.latency.reports\ndebug.latency.reset"))
+    {
+        return KBDAPI_EVENT_RESULT_IGNORED;
+    }
+
+    if (strcmp(p_command, "debug.latency") == 0)
+    {
+        /*
+         * For BLE and then USB, the total latency count, min, p50, p90, p99 and max, followed by the processing and
+         * the transmission avg and max. All in us, the percentiles have the resolution of the histogram buckets.
+         */
+        for ( uint8_t transport = 0; transport < TRANSPORT_COUNT; transport++ )
+        {
+            const stats_t * p_stats = &p_trace->stats[ transport ];
+
+            ::Focus.send( p_stats->total.count, p_stats->total.min, dl_stats_percentile_get( &p_stats->total, 50 ),
+                          dl_stats_percentile_get( &p_stats->total, 90 ), dl_stats_percentile_get( &p_stats->total, 99 ),
+                          p_stats->total.max );
+            ::Focus.send( dl_stats_avg_get( &p_stats->process ), p_stats->process.max,
+                          dl_stats_avg_get( &p_stats->transmit ), p_stats->transmit.max );
+        }
+    }
+    else if (strcmp(p_command, "debug.latency.histogram") == 0)
+    {
+        /* The total latency histogram of BLE and then USB */
+        for ( uint8_t transport = 0; transport < TRANSPORT_COUNT; transport++ )
+        {
+            for ( uint8_t bucket = 0; bucket < DL_STATS_HIST_BUCKETS; bucket++ )
+            {
+                ::Focus.send( p_trace->stats[ transport ].total.hist[ bucket ] );
+            }
+        }
+    }
+    else if (strcmp(p_command, "debug.latency.reports") == 0)
+    {
+        p_trace->reports_dump();
+    }
+    else if (strcmp(p_command, "debug.latency.reset") == 0)
+    {
+        p_trace->stats_reset();
+    }
+    else
+    {
+        return KBDAPI_EVENT_RESULT_IGNORED;
+    }
+
+    return KBDAPI_EVENT_RESULT_CONSUMED;
+}
+
+const kbdif_handlers_t LatencyTrace::kbdif_handlers =
+{
+    .key_event_cb = NULL,
+    .command_event_cb = kbdif_command_event_cb,
+};
+
+class LatencyTrace LatencyTrace;
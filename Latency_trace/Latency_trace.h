@@ -0,0 +1,77 @@
+/* -*- mode: c++ -*-
+ * Latency_trace -- Key to host latency of the keyboard reports
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "kbd_if.h"
+
+/*
+ * The key event is marked when its packet arrives from the keyscanner. The HID layer carries that time with the next
+ * keyboard report, stamps it when queued and reports it once sent ( HID_TX_LATENCY_ENABLED ). The latency is split
+ * into the processing ( the event to the report queued, including the kbdif dispatch and the key handling ) and the
+ * transmission ( the report queued to sent ), with the statistics kept per transport and exposed through the
+ * debug.latency Focus commands.
+ *
+ * A key event changing no keyboard report ( a layer key for example ) is dropped once it is older than
+ * HID_TX_LATENCY_EVENT_TIMEOUT_US, and so is an event merged into a queued report which already carries an older one.
+ *
+ * debug.latency.reports dumps the reports submitted since the previous dump, from the HIDReportObserver trace ring.
+ */
+
+class LatencyTrace {
+
+  public:
+    typedef enum
+    {
+        TRANSPORT_BLE = 0,
+        TRANSPORT_USB,
+
+        TRANSPORT_COUNT,
+    } transport_t;
+
+    typedef struct
+    {
+        dl_stats_t process;         /* The key event to the report queued, in us */
+        dl_stats_t transmit;        /* The report queued to sent, in us */
+        dl_stats_t total;
+    } stats_t;
+
+    result_t init( void );
+
+    /* To be called on every key event received from the RF pipe. The SPI link marks the keyscanner events itself */
+    void key_in( void );
+
+  private:
+    stats_t stats[ TRANSPORT_COUNT ];
+    uint32_t report_cursor = 0;
+
+    kbdif_t * p_kbdif = NULL;
+    result_t kbdif_initialize(void);
+
+    void stats_reset( void );
+    void reports_dump( void );
+
+    static uint32_t clock_get( void );
+    static void report_sent_cb( bool ble, uint32_t t_event, uint32_t t_queued, uint32_t t_sent );
+
+    static const kbdif_handlers_t kbdif_handlers;
+
+    static kbdapi_event_result_t kbdif_command_event_cb( void * p_instance, const char * p_command );
+};
+
+extern class LatencyTrace LatencyTrace;
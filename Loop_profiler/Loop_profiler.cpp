@@ -0,0 +1,191 @@
+/* -*- mode: c++ -*-
+ * Loop_profiler -- Dump of the main loop profiler over Focus
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Loop_profiler.h"
+#include "Kaleidoscope-FocusSerial.h"
+
+#include "kbd_if_manager.h"
+#include "halsep/hal_mcu.h"
+#include "hidDefy.h"
+
+result_t LoopProfiler::init( void )
+{
+    result_t result = RESULT_ERR;
+
+    result = kbdif_initialize();
+    EXIT_IF_ERR( result, "kbdif_initialize failed" );
+
+#if SCHED_PROF_ENABLED
+    dl_stats_reset( &hid_send_prof );
+
+    HID().txProfileHookSet( hid_send_prof_cb );
+#endif
+
+_EXIT:
+    return result;
+}
+
+result_t LoopProfiler::kbdif_initialize()
+{
+    result_t result = RESULT_ERR;
+    kbdif_conf_t config;
+
+    /* Prepare the kbdif configuration */
+    config.p_instance = this;
+    config.handlers = &kbdif_handlers;
+
+    /* Initialize the kbdif */
+    result = kbdif_init( &p_kbdif, &config );
+    EXIT_IF_ERR( result, "kbdif_init failed" );
+
+    /* Add the kbdif into the kbdif manager */
+    result = kbdifmgr_add( p_kbdif );
+    EXIT_IF_ERR( result, "kbdifmgr_add failed" );
+
+_EXIT:
+    return result;
+}
+
+#if SCHED_PROF_ENABLED
+#define LOOP_PROFILE_HELP       "\ndebug.loop\ndebug.loop.histogram\ndebug.loop.reset"
+#else
+#define LOOP_PROFILE_HELP       ""
+#endif
+
+kbdapi_event_result_t LoopProfiler::kbdif_command_event_cb( void * p_instance, const char * p_command )
+{
+    UNUSED( p_instance );
+
+    if (::Focus.handleHelp(p_command, "debug.wake\ndebug.wake.reset" LOOP_PROFILE_HELP))
+    {
+        return KBDAPI_EVENT_RESULT_IGNORED;
+    }
+
+    if (strcmp(p_command, "debug.wake") == 0)
+    {
+        const mcu_wake_stats_t * p_stats = mcu_wake_stats_get();
+
+        /* The sleeps count followed by the loop passes kept awake by each source, in the mcu_wake_src_t order */
+        ::Focus.send( p_stats->sleep_count );
+
+        for ( uint8_t src = 0; src < MCU_WAKE_SRC_COUNT; src++ )
+        {
+            ::Focus.send( p_stats->awake_count[ src ] );
+        }
+    }
+    else if (strcmp(p_command, "debug.wake.reset") == 0)
+    {
+        mcu_wake_stats_reset();
+    }
+#if SCHED_PROF_ENABLED
+    else if (strncmp(p_command, "debug.loop", 10) == 0)
+    {
+        return loop_command_process( p_command + 10 );
+    }
+#endif
+    else
+    {
+        return KBDAPI_EVENT_RESULT_IGNORED;
+    }
+
+    return KBDAPI_EVENT_RESULT_CONSUMED;
+}
+
+#if SCHED_PROF_ENABLED
+void LoopProfiler::hid_send_prof_cb( bool begin )
+{
+    if ( begin )
+    {
+        ::LoopProfiler.hid_send_start = hal_mcu_cyccnt_get();
+    }
+    else
+    {
+        dl_stats_add( &::LoopProfiler.hid_send_prof, hal_mcu_cyccnt_get() - ::LoopProfiler.hid_send_start );
+    }
+}
+
+kbdapi_event_result_t LoopProfiler::loop_command_process( const char * p_command )
+{
+    const sched_task_t * p_task;
+    const dl_stats_t * p_hid_send = &::LoopProfiler.hid_send_prof;
+
+    if (strcmp(p_command, "") == 0)
+    {
+        const sched_prof_t * p_prof = sched_prof_get();
+
+        /* The cycles per us, the pass count, min, avg and max work in cycles, the period min, avg and max and the jitter avg and max in us */
+        ::Focus.send( (uint32_t)HAL_MCU_CYCCNT_PER_US );
+        ::Focus.send( p_prof->pass.count, p_prof->pass.min, dl_stats_avg_get( &p_prof->pass ), p_prof->pass.max,
+                      p_prof->period.min, dl_stats_avg_get( &p_prof->period ), p_prof->period.max,
+                      dl_stats_avg_get( &p_prof->jitter ), p_prof->jitter.max );
+
+        /* Then the tasks in the order of their priority. The name, run count, avg and max in cycles and the total in us */
+        for ( p_task = sched_task_next_get( NULL ); p_task != NULL; p_task = sched_task_next_get( p_task ) )
+        {
+            const dl_stats_t * p_stats = sched_task_prof_get( p_task );
+
+            ::Focus.send( sched_task_name_get( p_task ), p_stats->count, dl_stats_avg_get( p_stats ), p_stats->max,
+                          (uint32_t)( p_stats->total / HAL_MCU_CYCCNT_PER_US ) );
+        }
+
+        /* And the SendLastReport calls of the main loop, in the same format */
+        ::Focus.send( "hid.send", p_hid_send->count, dl_stats_avg_get( p_hid_send ), p_hid_send->max,
+                      (uint32_t)( p_hid_send->total / HAL_MCU_CYCCNT_PER_US ) );
+    }
+    else if (strcmp(p_command, ".histogram") == 0)
+    {
+        /* The pass work histogram followed by the task run and the SendLastReport histograms, all in cycles */
+        for ( uint8_t bucket = 0; bucket < DL_STATS_HIST_BUCKETS; bucket++ )
+        {
+            ::Focus.send( sched_prof_get()->pass.hist[ bucket ] );
+        }
+
+        for ( p_task = sched_task_next_get( NULL ); p_task != NULL; p_task = sched_task_next_get( p_task ) )
+        {
+            for ( uint8_t bucket = 0; bucket < DL_STATS_HIST_BUCKETS; bucket++ )
+            {
+                ::Focus.send( sched_task_prof_get( p_task )->hist[ bucket ] );
+            }
+        }
+
+        for ( uint8_t bucket = 0; bucket < DL_STATS_HIST_BUCKETS; bucket++ )
+        {
+            ::Focus.send( p_hid_send->hist[ bucket ] );
+        }
+    }
+    else if (strcmp(p_command, ".reset") == 0)
+    {
+        sched_prof_reset();
+        dl_stats_reset( &::LoopProfiler.hid_send_prof );
+    }
+    else
+    {
+        return KBDAPI_EVENT_RESULT_IGNORED;
+    }
+
+    return KBDAPI_EVENT_RESULT_CONSUMED;
+}
+#endif
+
+const kbdif_handlers_t LoopProfiler::kbdif_handlers =
+{
+    .key_event_cb = NULL,
+    .command_event_cb = kbdif_command_event_cb,
+};
+
+class LoopProfiler LoopProfiler;
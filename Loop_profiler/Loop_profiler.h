@@ -0,0 +1,51 @@
+/* -*- mode: c++ -*-
+ * Loop_profiler -- Dump of the main loop profiler over Focus
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "kbd_if.h"
+
+/*
+ * The profile is collected by the scheduler around each module task when SCHED_PROF_ENABLED is set, and the wake
+ * statistics by the MCU sleep control. This module only exposes them through the debug.loop and debug.wake Focus
+ * commands. It profiles HID().SendLastReport itself, as the main loop calls it outside of the tasks.
+ */
+
+class LoopProfiler {
+
+  public:
+    result_t init( void );
+
+  private:
+    kbdif_t * p_kbdif = NULL;
+    result_t kbdif_initialize(void);
+
+    static const kbdif_handlers_t kbdif_handlers;
+
+    static kbdapi_event_result_t kbdif_command_event_cb( void * p_instance, const char * p_command );
+#if SCHED_PROF_ENABLED
+    static kbdapi_event_result_t loop_command_process( const char * p_command );
+
+    dl_stats_t hid_send_prof;           /* The SendLastReport calls, in cycles */
+    uint32_t hid_send_start;
+
+    static void hid_send_prof_cb( bool begin );
+#endif
+};
+
+extern class LoopProfiler LoopProfiler;
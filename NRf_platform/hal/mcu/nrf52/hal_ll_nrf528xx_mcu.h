@@ -26,6 +26,24 @@
 #ifndef __HAL_LL_NRF528XX_MCU_H_
 #define __HAL_LL_NRF528XX_MCU_H_
 
+#include "nrf.h"
 
+#define HAL_LL_MCU_CYCCNT_PER_US        ( SystemCoreClock / 1000000UL )
+
+/*
+ * Cycle counter of the DWT unit. It counts the core clock cycles, so it stops while the core sleeps.
+ */
+
+static INLINE void hal_ll_mcu_cyccnt_enable( void )
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static INLINE uint32_t hal_ll_mcu_cyccnt_get( void )
+{
+    return DWT->CYCCNT;
+}
 
 #endif /* __HAL_LL_NRF528XX_MCU_H_ */
@@ -40,6 +40,10 @@ extern "C" {
 #include "utils/dl_utils.h"
 
 #include "utils/dl_crc32.h"
+#include "utils/dl_stats.h"
+
+#include "system/sched.h"
+#include "system/defer.h"
 
 #include "config_app.h"
 
@@ -0,0 +1,169 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "defer.h"
+
+#if ( DEFER_QUEUE_SIZE & ( DEFER_QUEUE_SIZE - 1 ) ) != 0
+    #error "DEFER_QUEUE_SIZE must be a power of 2"
+#endif
+
+#define DEFER_QUEUE_MASK        ( DEFER_QUEUE_SIZE - 1 )
+
+typedef struct
+{
+    defer_handler_t handler;
+    void * p_ctx;
+    uint32_t arg;
+
+    volatile bool_t filled;         /* Set by the producer once the item is complete */
+} defer_item_t;
+
+typedef struct
+{
+    defer_item_t items[ DEFER_QUEUE_SIZE ];
+
+    /* Free running indexes. The write index is claimed by the producers, the read index is owned by the consumer */
+    volatile uint32_t write;
+    volatile uint32_t read;
+
+    sched_task_t * p_sched_task;
+
+    defer_stats_t stats;
+} defer_t;
+
+static defer_t defer;
+
+/* Prototypes */
+static void _sched_task_run_cb( void * p_instance );
+
+result_t defer_init( void )
+{
+    result_t result = RESULT_ERR;
+    sched_task_conf_t config;
+
+    memset( &defer, 0x00, sizeof( defer ) );
+
+    /* The queue is drained by a high priority task, so the deferred work goes before the rest of the main loop */
+    config.p_name = "defer";
+    config.p_instance = NULL;
+    config.run = _sched_task_run_cb;
+
+    config.prio = SCHED_PRIO_HIGH;
+    config.poll = false;
+    config.wake = false;
+    config.budget_us = 0;
+
+    result = sched_task_add( &defer.p_sched_task, &config );
+    EXIT_IF_ERR( result, "sched_task_add failed" );
+
+_EXIT:
+    return result;
+}
+
+bool_t defer_post( defer_handler_t handler, void * p_ctx, uint32_t arg )
+{
+    defer_item_t * p_item;
+    uint32_t write;
+    uint32_t depth;
+
+    if( defer.p_sched_task == NULL )
+    {
+        /* Not initialized, there is nobody to run the item later */
+        handler( p_ctx, arg );
+        return true;
+    }
+
+    /* Claim the write slot. A higher priority interrupt may claim one in between, so we retry in that case */
+    write = __atomic_load_n( &defer.write, __ATOMIC_RELAXED );
+    do
+    {
+        if( write - defer.read >= DEFER_QUEUE_SIZE )
+        {
+            /* The queue is full. Its size does not cover the producers, see defer.h. The item is dropped and counted */
+            defer.stats.overflow_count++;
+            return false;
+        }
+    } while( __atomic_compare_exchange_n( &defer.write, &write, write + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) == false );
+
+    p_item = &defer.items[ write & DEFER_QUEUE_MASK ];
+    p_item->handler = handler;
+    p_item->p_ctx = p_ctx;
+    p_item->arg = arg;
+    __atomic_store_n( &p_item->filled, true, __ATOMIC_RELEASE );
+
+    /* Statistics. Only approximate when the producers preempt each other */
+    defer.stats.post_count++;
+    depth = write + 1 - defer.read;
+    if( depth > defer.stats.depth_max )
+    {
+        defer.stats.depth_max = depth;
+    }
+
+    /* Let the main loop run the item */
+    mcu_wake_event_set( MCU_WAKE_SRC_DEFER );
+    sched_task_ready( defer.p_sched_task );
+
+    return true;
+}
+
+void defer_run( void )
+{
+    defer_item_t * p_item;
+    defer_handler_t handler;
+    void * p_ctx;
+    uint32_t arg;
+
+    while( defer.read != __atomic_load_n( &defer.write, __ATOMIC_ACQUIRE ) )
+    {
+        p_item = &defer.items[ defer.read & DEFER_QUEUE_MASK ];
+
+        if( __atomic_load_n( &p_item->filled, __ATOMIC_ACQUIRE ) == false )
+        {
+            /* The producer has been preempted while filling the item. It makes the task ready again once done */
+            break;
+        }
+
+        /* Copy the item out and free the slot before running it, so the handler can post again */
+        handler = p_item->handler;
+        p_ctx = p_item->p_ctx;
+        arg = p_item->arg;
+
+        p_item->filled = false;
+        __atomic_store_n( &defer.read, defer.read + 1, __ATOMIC_RELEASE );
+
+        handler( p_ctx, arg );
+    }
+}
+
+const defer_stats_t * defer_stats_get( void )
+{
+    return &defer.stats;
+}
+
+static void _sched_task_run_cb( void * p_instance )
+{
+    UNUSED( p_instance );
+
+    defer_run();
+}
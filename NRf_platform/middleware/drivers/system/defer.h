@@ -0,0 +1,71 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __DEFER_H_
+#define __DEFER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dl_middleware.h"
+
+/*
+ * Deferred work queue. The interrupt handlers post their work as ( handler, context, argument ) items and the items
+ * are run later by a high priority scheduler task in the main loop, in the order of their posting. The posting is
+ * lock-free, so it can be used from the interrupts of any priority.
+ *
+ * Each producer must bound the items it can have pending, e.g. by posting the next one only after the main loop has
+ * handled the previous. The queue is sized for the sum of those bounds: the SPI link slave has up to 3 per instance
+ * ( the data in, the data out and the poll request ) and the EEPROM log flush 1, as it is posted only when no flush is
+ * pending. An item posted to a full queue is
+ * dropped and counted, as running it within the interrupt would take it out of order.
+ */
+
+#ifndef DEFER_QUEUE_SIZE
+#define DEFER_QUEUE_SIZE            16          /* Must be a power of 2 */
+#endif
+
+typedef void (*defer_handler_t)( void * p_ctx, uint32_t arg );
+
+typedef struct
+{
+    uint32_t post_count;
+    uint32_t overflow_count;        /* Items dropped because of the full queue */
+    uint32_t depth_max;
+} defer_stats_t;
+
+extern result_t defer_init( void );
+
+/* Can be called from the interrupts. Returns false if the item was dropped because of the full queue */
+extern bool_t defer_post( defer_handler_t handler, void * p_ctx, uint32_t arg );
+
+extern void defer_run( void );
+extern const defer_stats_t * defer_stats_get( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DEFER_H_ */
@@ -26,15 +26,24 @@
 #include "mcu.h"
 #include "halsep/hal_mcu_pwr.h"
 
+#ifndef MCU_SLEEP_DEADLINE_MIN_US
+#define MCU_SLEEP_DEADLINE_MIN_US       100     /* The sleep is skipped when the next deadline is closer than this */
+#endif
+
 typedef struct
 {
-    bool_t sleep_now;
+    volatile uint32_t wake_events;
+    mcu_wake_stats_t wake_stats;
+    uint32_t sleep_seq;
+
+    mcu_sleep_deadline_get_t deadline_get;
 } mcu_t;
 
 static mcu_t mcu;
 
 /* Prototypes */
 static result_t _sleep_init( mcu_t * p_mcu );
+static bool_t _sleep_deadline_near( mcu_t * p_mcu );
 
 result_t mcu_init( void )
 {
@@ -58,7 +67,8 @@ static result_t _sleep_init( mcu_t * p_mcu )
     result = hal_mcu_pwr_init();
     EXIT_IF_ERR( result, "hal_mcu_pwr_init failed" );
 
-    mcu.sleep_now = true;
+    p_mcu->wake_events = 0;
+    memset( &p_mcu->wake_stats, 0x00, sizeof( p_mcu->wake_stats ) );
 
 _EXIT:
     return result;
@@ -71,15 +81,72 @@ result_t mcu_sleep_init( void )
 
 void mcu_sleep_postpone( void )
 {
-    mcu.sleep_now = false;
+    mcu_wake_event_set( MCU_WAKE_SRC_OTHER );
+}
+
+void mcu_wake_event_set( mcu_wake_src_t src )
+{
+    __atomic_fetch_or( &mcu.wake_events, ( 1UL << src ), __ATOMIC_RELAXED );
+}
+
+uint32_t mcu_sleep_seq_get( void )
+{
+    return mcu.sleep_seq;
+}
+
+const mcu_wake_stats_t * mcu_wake_stats_get( void )
+{
+    return &mcu.wake_stats;
+}
+
+void mcu_wake_stats_reset( void )
+{
+    memset( &mcu.wake_stats, 0x00, sizeof( mcu.wake_stats ) );
+}
+
+void mcu_sleep_deadline_source_set( mcu_sleep_deadline_get_t deadline_get )
+{
+    mcu.deadline_get = deadline_get;
+}
+
+static bool_t _sleep_deadline_near( mcu_t * p_mcu )
+{
+    uint32_t time_left_us;
+
+    if ( p_mcu->deadline_get == NULL || p_mcu->deadline_get( &time_left_us ) == false )
+    {
+        return false;
+    }
+
+    return ( time_left_us < MCU_SLEEP_DEADLINE_MIN_US ) ? true : false;
 }
 
 void mcu_sleep_control( void )
 {
-    if ( mcu.sleep_now == true )
+    uint32_t wake_events;
+    uint8_t src;
+
+    /* Take the events of this pass. The ones set from now on keep the next pass awake */
+    wake_events = __atomic_exchange_n( &mcu.wake_events, 0, __ATOMIC_RELAXED );
+
+    if ( wake_events != 0 )
     {
-        hal_mcu_pwr_sleep_handle();
+        for ( src = 0; src < MCU_WAKE_SRC_COUNT; src++ )
+        {
+            if ( ( wake_events & ( 1UL << src ) ) != 0 )
+            {
+                mcu.wake_stats.awake_count[ src ]++;
+            }
+        }
+
+        return;
     }
 
-    mcu.sleep_now = true;
+    /* The wake up for the next deadline is already programmed, so the sleep is skipped only if it is due right away */
+    if ( _sleep_deadline_near( &mcu ) == false )
+    {
+        mcu.wake_stats.sleep_count++;
+        mcu.sleep_seq++;
+        hal_mcu_pwr_sleep_handle();
+    }
 }
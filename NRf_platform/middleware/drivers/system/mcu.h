@@ -32,12 +32,46 @@ extern "C" {
 
 #include "dl_middleware.h"
 
+/*
+ * Wake events. Each source sets its bit when it has work pending and the main loop does not sleep until all the pending
+ * events have been through a loop pass. The passes kept awake are counted per source.
+ */
+typedef enum
+{
+    MCU_WAKE_SRC_OTHER = 0,         /* mcu_sleep_postpone() */
+    MCU_WAKE_SRC_SCHED,             /* Scheduler tasks made ready */
+    MCU_WAKE_SRC_DEFER,             /* Deferred interrupt work */
+    MCU_WAKE_SRC_SPI_LINK,
+    MCU_WAKE_SRC_CONFIG,
+
+    MCU_WAKE_SRC_COUNT,
+} mcu_wake_src_t;
+
+typedef struct
+{
+    uint32_t sleep_count;
+    uint32_t awake_count[ MCU_WAKE_SRC_COUNT ];     /* The loop passes which did not sleep because of the source */
+} mcu_wake_stats_t;
+
 extern result_t mcu_init( void );
 
 extern result_t mcu_sleep_init( void );
 extern void mcu_sleep_postpone( void );
 extern void mcu_sleep_control( void );
 
+/* Can be called from the interrupts */
+extern void mcu_wake_event_set( mcu_wake_src_t src );
+
+/* Counts the sleeps and it is never reset, so the modules can tell whether the core slept since they last looked */
+extern uint32_t mcu_sleep_seq_get( void );
+
+extern const mcu_wake_stats_t * mcu_wake_stats_get( void );
+extern void mcu_wake_stats_reset( void );
+
+/* Returns false if there is no deadline pending. Otherwise the time left to the earliest one, in microseconds */
+typedef bool_t (*mcu_sleep_deadline_get_t)( uint32_t * p_time_left_us );
+extern void mcu_sleep_deadline_source_set( mcu_sleep_deadline_get_t deadline_get );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,300 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sched.h"
+#include "halsep/hal_mcu.h"
+
+#if SCHED_PROF_ENABLED
+#define PROF_CYCLES_GET( cycles )                   uint32_t cycles = hal_mcu_cyccnt_get()
+#define PROF_TASK_ADD( p_task, start )              dl_stats_add( &(p_task)->prof, hal_mcu_cyccnt_get() - ( start ) )
+#define PROF_PASS_START( time )                     _prof_pass_start( time )
+#define PROF_PASS_ADD( start )                      dl_stats_add( &sched.prof.pass, hal_mcu_cyccnt_get() - ( start ) )
+#else
+#define PROF_CYCLES_GET( cycles )
+#define PROF_TASK_ADD( p_task, start )
+#define PROF_PASS_START( time )
+#define PROF_PASS_ADD( start )
+#endif
+
+struct sched_task
+{
+    sched_task_conf_t conf;
+    sched_task_stats_t stats;
+
+    volatile bool_t ready;
+    bool_t poll_pending;
+
+#if SCHED_PROF_ENABLED
+    dl_stats_t prof;
+#endif
+
+    sched_task_t * p_next;
+};
+
+typedef struct
+{
+    sched_task_t * p_head;          /* Sorted by the priority */
+    sched_time_get_t time_get;
+    uint32_t sleep_seq_last;        /* To find the passes following a sleep */
+
+#if SCHED_PROF_ENABLED
+    sched_prof_t prof;
+    uint64_t prof_pass_time_last;
+    uint32_t prof_period_last;
+#endif
+} sched_t;
+
+static sched_t sched;
+
+/* Prototypes */
+static uint64_t _time_get( void );
+static sched_task_t * _task_next_get( void );
+static void _task_run( sched_task_t * p_task );
+#if SCHED_PROF_ENABLED
+static void _prof_pass_start( uint64_t time );
+#endif
+
+static uint64_t _time_get( void )
+{
+    /* Without the time source the budgets are not applied */
+    return ( sched.time_get != NULL ) ? sched.time_get() : 0;
+}
+
+void sched_time_source_set( sched_time_get_t time_get )
+{
+    sched.time_get = time_get;
+}
+
+result_t sched_task_add( sched_task_t ** pp_task, const sched_task_conf_t * p_conf )
+{
+    sched_task_t * p_task;
+    sched_task_t ** pp_position;
+
+    ASSERT_DYGMA( p_conf->run != NULL, "The task run function cannot be NULL" );
+
+    p_task = heap_alloc( sizeof( sched_task_t ) );
+
+    memcpy( &p_task->conf, p_conf, sizeof( p_task->conf ) );
+    memset( &p_task->stats, 0x00, sizeof( p_task->stats ) );
+
+    p_task->ready = false;
+    p_task->poll_pending = false;
+
+#if SCHED_PROF_ENABLED
+    dl_stats_reset( &p_task->prof );
+
+    if( sched.p_head == NULL )
+    {
+        /* The first task, start the profiler */
+        hal_mcu_cyccnt_enable();
+        sched_prof_reset();
+    }
+#endif
+
+    /* Keep the order of addition within the same priority */
+    pp_position = &sched.p_head;
+    while( *pp_position != NULL && (*pp_position)->conf.prio <= p_task->conf.prio )
+    {
+        pp_position = &(*pp_position)->p_next;
+    }
+
+    p_task->p_next = *pp_position;
+    *pp_position = p_task;
+
+    *pp_task = p_task;
+
+    return RESULT_OK;
+}
+
+void sched_task_ready( sched_task_t * p_task )
+{
+    p_task->ready = true;
+
+    /* Keep the loop awake until the task runs */
+    mcu_wake_event_set( MCU_WAKE_SRC_SCHED );
+}
+
+const sched_task_stats_t * sched_task_stats_get( const sched_task_t * p_task )
+{
+    return &p_task->stats;
+}
+
+static sched_task_t * _task_next_get( void )
+{
+    sched_task_t * p_task;
+
+    /* The list is sorted, so the first ready task is the most urgent one */
+    for( p_task = sched.p_head; p_task != NULL; p_task = p_task->p_next )
+    {
+        if( p_task->ready == true || p_task->poll_pending == true )
+        {
+            break;
+        }
+    }
+
+    return p_task;
+}
+
+static void _task_run( sched_task_t * p_task )
+{
+    uint64_t time_start;
+    uint32_t run_time;
+
+    p_task->ready = false;
+    p_task->poll_pending = false;
+
+    time_start = _time_get();
+    PROF_CYCLES_GET( cycles_start );
+
+    p_task->conf.run( p_task->conf.p_instance );
+
+    PROF_TASK_ADD( p_task, cycles_start );
+    run_time = ( uint32_t )( _time_get() - time_start );
+
+    p_task->stats.run_count++;
+    if( run_time > p_task->stats.run_time_max_us )
+    {
+        p_task->stats.run_time_max_us = run_time;
+    }
+    if( p_task->conf.budget_us != 0 && run_time > p_task->conf.budget_us )
+    {
+        p_task->stats.overrun_count++;
+    }
+}
+
+void sched_run( void )
+{
+    sched_task_t * p_task;
+    uint64_t pass_start;
+    uint16_t runs = 0;
+    uint32_t sleep_seq;
+    bool_t woken;
+
+    pass_start = _time_get();
+    PROF_PASS_START( pass_start );
+    PROF_CYCLES_GET( cycles_start );
+
+    sleep_seq = mcu_sleep_seq_get();
+    woken = ( sleep_seq != sched.sleep_seq_last ) ? true : false;
+    sched.sleep_seq_last = sleep_seq;
+
+    /* The polled tasks run once per pass, the wake ones once per pass following a sleep */
+    for( p_task = sched.p_head; p_task != NULL; p_task = p_task->p_next )
+    {
+        p_task->poll_pending = ( p_task->conf.poll == true || ( woken == true && p_task->conf.wake == true ) ) ? true : false;
+    }
+
+    while( ( p_task = _task_next_get() ) != NULL && runs < SCHED_PASS_RUNS_MAX )
+    {
+        if( p_task->conf.prio != SCHED_PRIO_HIGH && _time_get() - pass_start >= SCHED_PASS_BUDGET_US )
+        {
+            /* The budget is spent, the rest of the ready tasks waits for the next pass */
+            for( ; p_task != NULL; p_task = p_task->p_next )
+            {
+                if( p_task->ready == true || p_task->poll_pending == true )
+                {
+                    p_task->stats.defer_count++;
+                }
+            }
+
+            break;
+        }
+
+        _task_run( p_task );
+        runs++;
+    }
+
+    if( _task_next_get() != NULL )
+    {
+        /* Deferred by the budget or made ready meanwhile, the loop must not sleep before the next pass */
+        mcu_wake_event_set( MCU_WAKE_SRC_SCHED );
+    }
+
+    PROF_PASS_ADD( cycles_start );
+}
+
+#if SCHED_PROF_ENABLED
+/*******************************************/
+/*                Profiler                 */
+/*******************************************/
+
+static void _prof_pass_start( uint64_t time )
+{
+    uint32_t period;
+    uint32_t jitter;
+
+    if( sched.prof_pass_time_last != 0 )
+    {
+        period = ( uint32_t )( time - sched.prof_pass_time_last );
+        dl_stats_add( &sched.prof.period, period );
+
+        if( sched.prof.period.count > 1 )
+        {
+            jitter = ( period > sched.prof_period_last ) ? period - sched.prof_period_last : sched.prof_period_last - period;
+            dl_stats_add( &sched.prof.jitter, jitter );
+        }
+
+        sched.prof_period_last = period;
+    }
+
+    sched.prof_pass_time_last = time;
+}
+
+const sched_task_t * sched_task_next_get( const sched_task_t * p_task )
+{
+    return ( p_task == NULL ) ? sched.p_head : p_task->p_next;
+}
+
+const char * sched_task_name_get( const sched_task_t * p_task )
+{
+    return ( p_task->conf.p_name != NULL ) ? p_task->conf.p_name : "";
+}
+
+const dl_stats_t * sched_task_prof_get( const sched_task_t * p_task )
+{
+    return &p_task->prof;
+}
+
+const sched_prof_t * sched_prof_get( void )
+{
+    return &sched.prof;
+}
+
+void sched_prof_reset( void )
+{
+    sched_task_t * p_task;
+
+    for( p_task = sched.p_head; p_task != NULL; p_task = p_task->p_next )
+    {
+        dl_stats_reset( &p_task->prof );
+    }
+
+    dl_stats_reset( &sched.prof.pass );
+    dl_stats_reset( &sched.prof.period );
+    dl_stats_reset( &sched.prof.jitter );
+
+    /* The next pass starts a new period */
+    sched.prof_pass_time_last = 0;
+}
+#endif
@@ -0,0 +1,124 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __SCHED_H_
+#define __SCHED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dl_middleware.h"
+
+/*
+ * Cooperative scheduler of the module tasks. Each pass runs the ready tasks in the order of their priority, and it
+ * looks for the most urgent ready task again after each one, so the work made ready by an interrupt goes before the
+ * lower priority tasks still waiting. Once the pass has spent its budget, only the high priority tasks are run and the
+ * rest waits for the next pass.
+ */
+
+#ifndef SCHED_PASS_BUDGET_US
+#define SCHED_PASS_BUDGET_US        1000
+#endif
+
+#ifndef SCHED_PASS_RUNS_MAX
+#define SCHED_PASS_RUNS_MAX         32          /* Protection against the tasks made ready faster than they can run */
+#endif
+
+/*
+ * Loop profiler. The task runs and the pass work are measured in the core cycles, the pass period and its jitter
+ * ( the difference from the previous period ) in us, as the cycle counter stops while the core sleeps.
+ */
+#ifndef SCHED_PROF_ENABLED
+#define SCHED_PROF_ENABLED          0
+#endif
+
+typedef enum
+{
+    SCHED_PRIO_HIGH = 0,            /* Latency critical work ( e.g. the SPI link, the HID reports ) */
+    SCHED_PRIO_NORMAL,
+    SCHED_PRIO_LOW,                 /* Housekeeping ( e.g. the configuration saves ) */
+} sched_prio_t;
+
+typedef void (*sched_task_run_t)( void * p_instance );
+typedef uint64_t (*sched_time_get_t)( void );       /* Returns the time in us */
+
+typedef struct
+{
+    const char * p_name;            /* Used by the profiler dump */
+
+    void * p_instance;
+    sched_task_run_t run;
+
+    sched_prio_t prio;
+    bool_t poll;                    /* Run the task in every pass, for the modules without the ready events */
+    bool_t wake;                    /* Run the task in the first pass after the core slept, for the modules driven by
+                                       the interrupts of a library which does not report all its events */
+    uint32_t budget_us;             /* The expected maximum run time. The longer runs are only counted, as a hint for
+                                       splitting the task. Zero to disable */
+} sched_task_conf_t;
+
+typedef struct
+{
+    uint32_t run_count;
+    uint32_t run_time_max_us;
+    uint32_t overrun_count;         /* Runs longer than the task budget */
+    uint32_t defer_count;           /* Passes which left the task ready because of the pass budget */
+} sched_task_stats_t;
+
+typedef struct sched_task sched_task_t;
+
+#if SCHED_PROF_ENABLED
+typedef struct
+{
+    dl_stats_t pass;                /* The work of the passes, in cycles */
+    dl_stats_t period;              /* The time between the pass starts, in us */
+    dl_stats_t jitter;              /* The period change between consecutive passes, in us */
+} sched_prof_t;
+#endif
+
+extern void sched_time_source_set( sched_time_get_t time_get );
+
+extern result_t sched_task_add( sched_task_t ** pp_task, const sched_task_conf_t * p_conf );
+/* Can be called from the interrupts */
+extern void sched_task_ready( sched_task_t * p_task );
+extern const sched_task_stats_t * sched_task_stats_get( const sched_task_t * p_task );
+
+extern void sched_run( void );
+
+#if SCHED_PROF_ENABLED
+/* The tasks are iterated in the order of their priority, starting with NULL. Returns NULL after the last one */
+extern const sched_task_t * sched_task_next_get( const sched_task_t * p_task );
+extern const char * sched_task_name_get( const sched_task_t * p_task );
+extern const dl_stats_t * sched_task_prof_get( const sched_task_t * p_task );   /* The runs in cycles */
+
+extern const sched_prof_t * sched_prof_get( void );
+extern void sched_prof_reset( void );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCHED_H_ */
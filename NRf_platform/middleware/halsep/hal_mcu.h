@@ -34,6 +34,19 @@ extern "C" {
 #include "hal_config.h"
 #include HAL_MCU_LL_MCU_LINK
 
+#define HAL_MCU_CYCCNT_PER_US           HAL_LL_MCU_CYCCNT_PER_US
+
+/* The core cycle counter. The reads are inlined, so it can be used to measure short code sections */
+static INLINE void hal_mcu_cyccnt_enable( void )
+{
+    hal_ll_mcu_cyccnt_enable();
+}
+
+static INLINE uint32_t hal_mcu_cyccnt_get( void )
+{
+    return hal_ll_mcu_cyccnt_get();
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,98 @@
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "dl_stats.h"
+
+static INLINE uint8_t _hist_bucket_get( uint32_t value )
+{
+    uint8_t bucket = ( value == 0 ) ? 0 : 32 - __builtin_clz( value );
+
+    return ( bucket < DL_STATS_HIST_BUCKETS ) ? bucket : DL_STATS_HIST_BUCKETS - 1;
+}
+
+void dl_stats_reset( dl_stats_t * p_stats )
+{
+    memset( p_stats, 0x00, sizeof( dl_stats_t ) );
+}
+
+void dl_stats_add( dl_stats_t * p_stats, uint32_t value )
+{
+    if( p_stats->count == 0 || value < p_stats->min )
+    {
+        p_stats->min = value;
+    }
+
+    if( value > p_stats->max )
+    {
+        p_stats->max = value;
+    }
+
+    p_stats->count++;
+    p_stats->total += value;
+    p_stats->hist[ _hist_bucket_get( value ) ]++;
+}
+
+uint32_t dl_stats_avg_get( const dl_stats_t * p_stats )
+{
+    if( p_stats->count == 0 )
+    {
+        return 0;
+    }
+
+    return p_stats->total / p_stats->count;
+}
+
+uint32_t dl_stats_percentile_get( const dl_stats_t * p_stats, uint8_t percent )
+{
+    uint64_t rank;
+    uint32_t cumulative = 0;
+    uint32_t value = p_stats->max;
+    uint8_t bucket;
+
+    if( p_stats->count == 0 )
+    {
+        return 0;
+    }
+
+    /* The rank of the percentile, rounded up */
+    rank = ( (uint64_t)p_stats->count * percent + 99 ) / 100;
+
+    for( bucket = 0; bucket < DL_STATS_HIST_BUCKETS - 1; bucket++ )
+    {
+        cumulative += p_stats->hist[ bucket ];
+        if( cumulative >= rank )
+        {
+            value = ( bucket == 0 ) ? 0 : ( 1UL << bucket ) - 1;
+            break;
+        }
+    }
+
+    if( value < p_stats->min )
+    {
+        value = p_stats->min;
+    }
+
+    return ( value < p_stats->max ) ? value : p_stats->max;
+}
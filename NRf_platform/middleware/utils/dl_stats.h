@@ -0,0 +1,64 @@
+
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __DL_STATS_H_
+#define __DL_STATS_H_
+
+#include "dl_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Running statistics of a measured value ( usually a time in us or cycles ). The histogram has logarithmic buckets:
+ * the bucket 0 counts the zeros and the bucket n counts the values within [ 2^(n-1), 2^n ). The last bucket also
+ * counts everything above.
+ */
+
+#define DL_STATS_HIST_BUCKETS   20
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+
+    uint32_t hist[ DL_STATS_HIST_BUCKETS ];
+} dl_stats_t;
+
+extern void dl_stats_reset( dl_stats_t * p_stats );
+extern void dl_stats_add( dl_stats_t * p_stats, uint32_t value );
+extern uint32_t dl_stats_avg_get( const dl_stats_t * p_stats );
+
+/* The percentile estimated from the histogram, i.e. the top of its bucket bounded by the min and max */
+extern uint32_t dl_stats_percentile_get( const dl_stats_t * p_stats, uint8_t percent );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DL_STATS_H_ */
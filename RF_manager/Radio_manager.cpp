@@ -37,6 +37,11 @@ result_t RadioManager::init()
     result = kbdif_initialize();
     EXIT_IF_ERR( result, "kbdif_initialize failed" );
 
+    result = sched_task_initialize();
+    EXIT_IF_ERR( result, "sched_task_initialize failed" );
+
+    rfhdev_api_event_cb_set( rf_event_cb );
+
     result = ConfigManager.config_item_request( ConfigManager::CFG_ITEM_TYPE_RF, (const void **)&p_rf_config );
     EXIT_IF_ERR( result, "ConfigManager.config_item_request failed" );
 
@@ -61,6 +66,9 @@ void RadioManager::enable()
     // Open the Keyscanner pipes.
     rfgw_pipe_open(RFGW_PIPE_ID_KEYSCANNER_LEFT);
     rfgw_pipe_open(RFGW_PIPE_ID_KEYSCANNER_RIGHT);
+
+    /* The gateway gets its first poll without waiting for an event */
+    sched_task_ready( p_sched_task );
 }
 
 void RadioManager::setPowerRF()
@@ -93,6 +101,41 @@ void RadioManager::poll()
     return rfgw_poll();
 }
 
+result_t RadioManager::sched_task_initialize()
+{
+    sched_task_conf_t config;
+
+    /* Prepare the scheduler task configuration */
+    config.p_name = "rf";
+    config.p_instance = NULL;       /* The module is whole static */
+    config.run = sched_task_run_cb;
+
+    config.prio = SCHED_PRIO_NORMAL;
+    config.poll = false;            /* Made ready by the RF gateway events */
+    config.wake = true;             /* The gateway timeouts are served by its own interrupts, without any event */
+    config.budget_us = 500;
+
+    return sched_task_add( &p_sched_task, &config );
+}
+
+void RadioManager::rf_event_cb(void)
+{
+    sched_task_ready( ::RadioManager.p_sched_task );
+}
+
+void RadioManager::sched_task_run_cb(void * p_instance)
+{
+    UNUSED( p_instance );
+
+    /* The RF gateway is polled only once it is enabled */
+    if( inited == false )
+    {
+        return;
+    }
+
+    rfgw_poll();
+}
+
 result_t RadioManager::kbdif_initialize()
 {
     result_t result = RESULT_ERR;
@@ -50,6 +50,11 @@ class RadioManager {
     kbdif_t * p_kbdif = NULL;
     result_t kbdif_initialize(void);
 
+    sched_task_t * p_sched_task = NULL;
+    result_t sched_task_initialize(void);
+    static void sched_task_run_cb(void * p_instance);
+    static void rf_event_cb(void);
+
   private:
 
     static const rf_config_t * p_rf_config;
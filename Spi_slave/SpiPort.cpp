@@ -124,6 +124,7 @@ bool SpiPort::sendPacket(Packet &packet) {
     if (spi_slave == nullptr) return false;
 
     spi_slave->tx_fifo->put(&packet);
+    spi_slave->tx_ready();
 
     return true;
 }
@@ -49,6 +49,7 @@
 #include "spi_link_slave.h"
 #include "Ble_composite_dev.h"
 #include "CRC_wrapper.h"
+#include "hidDefy.h"
 
 #define SPILS_MESSAGE_SIZE_MAX          (SPI_SLAVE_PACKET_SIZE * 4)
 #define SPILS_DISCONNECT_TIMEOUT_MS     1000
@@ -114,6 +115,12 @@ void Spi_slave::spils_event_handler( void * p_instance, spils_event_type_t event
 
             break;
 
+        case SPILS_EVENT_TYPE_POLL_REQUEST:
+
+            /* The run polls the link */
+
+            break;
+
         default:
 
             ASSERT_DYGMA( false, "Unhandled SPI Link Slave event" );
@@ -121,7 +128,8 @@ void Spi_slave::spils_event_handler( void * p_instance, spils_event_type_t event
             break;
     }
 
-
+    /* Process the event in the next scheduler pass */
+    sched_task_ready( p_slave->p_sched_task );
 }
 
 Spi_slave::Spi_slave(uint8_t _spi_port, uint32_t _miso_pin, uint32_t _mosi_pin, uint32_t _sck_pin, uint32_t _cs_pin, nrf_spis_mode_t _spi_mode)
@@ -181,6 +189,11 @@ void Spi_slave::init( void )
     config.p_instance = this;
     config.event_handler = spils_event_handler;
 
+    /* The task must exist before the first SPI link event */
+    result = sched_task_initialize();
+    ASSERT_DYGMA( result == RESULT_OK, "sched_task_initialize failed" );
+    EXIT_IF_ERR( result, "sched_task_initialize failed" );
+
     result = spils_init( &p_spils, &config );
     ASSERT_DYGMA( result == RESULT_OK, "spils_init failed" );
     EXIT_IF_ERR( result, "spils_init failed" );
@@ -189,12 +202,49 @@ _EXIT:
     return;
 }
 
+void Spi_slave::sched_task_run_cb( void * p_instance )
+{
+    Spi_slave * p_slave = ( Spi_slave *)p_instance;
+
+    p_slave->run();
+}
+
+result_t Spi_slave::sched_task_initialize( void )
+{
+    sched_task_conf_t config;
+
+    config.p_name = "spi";
+    config.p_instance = this;
+    config.run = sched_task_run_cb;
+
+    config.prio = SCHED_PRIO_HIGH;
+    config.poll = false;                /* Made ready by the SPI link events and the tx fifo puts ( tx_ready ) */
+    config.wake = false;
+    config.budget_us = 200;
+
+    return sched_task_add( &p_sched_task, &config );
+}
+
 void Spi_slave::run( void )
 {
     spils_poll( p_spils );
 
     data_in_process( );
     data_out_process( );
+
+    if( spils_data_in_received == true )
+    {
+        /* The input was busy or there is more of it */
+        sched_task_ready( p_sched_task );
+    }
+}
+
+void Spi_slave::tx_ready( void )
+{
+    if( p_sched_task != NULL )
+    {
+        sched_task_ready( p_sched_task );
+    }
 }
 
 bool_t Spi_slave::is_connected(void)
@@ -211,6 +261,12 @@ void Spi_slave::packet_in_process( Communications_protocol::Packet * p_spi_packe
     p_spi_packet->header.crc = 0;
     if ( crc8( p_spi_packet->buf, sizeof(Communications_protocol::Header) + p_spi_packet->header.size ) == spi_packet_crc )
     {
+        if ( p_spi_packet->header.command == Communications_protocol::HAS_KEYS )
+        {
+            /* Compiled out unless HID_TX_LATENCY_ENABLED */
+            HID().txLatencyEventMark();
+        }
+
         spi_rx_fifo.put( p_spi_packet );  // Put the new spi_packet in the Rx FIFO.
     }
 }
@@ -103,6 +103,9 @@ class Spi_slave {
     //void deinit(void);
     void run(void);
 
+    /* To be called after putting the packets into the tx_fifo */
+    void tx_ready(void);
+
     bool_t is_connected(void);
 
     Fifo_buffer *rx_fifo;
@@ -120,6 +123,8 @@ class Spi_slave {
 
     spils_t * p_spils;
 
+    sched_task_t * p_sched_task = NULL;
+
     /* Flags */
     bool_t is_connected_ = false;
 
@@ -132,6 +137,9 @@ class Spi_slave {
 
     static void spils_event_handler( void * p_instance, spils_event_type_t event_type );
 
+    static void sched_task_run_cb( void * p_instance );
+    result_t sched_task_initialize( void );
+
     void packet_in_process( Communications_protocol::Packet * p_spi_packet );
     void data_in_process(void);
     void data_out_process(void);
@@ -28,6 +28,7 @@
 #include "utils/dl_mutex.h"
 #include "spi_link_def.h"
 #include "spi_link_slave.h"
+#include "Time_counter.h"
 
 typedef enum
 {
@@ -95,7 +96,7 @@ struct spils
 
     /* Connection timer */
     uint32_t disconnect_timeout_ms;     /* Set 0 to disable */
-    uint32_t disconnect_timer_thres;    /* Time threshold for disconnect timer */
+    dl_sw_timer_t disconnect_timer;     /* Its deadline wakes the system up, so the disconnection is detected on time */
 
     /* Event handlers */
     void * p_instance;
@@ -112,6 +113,7 @@ static void _data_receive_start( spils_t * p_spils, spil_mess_type_t result_mess
 static void _data_send_start( spils_t * p_spils );
 
 static INLINE void _disconnect_timer_reset( spils_t * p_spils );
+static void _disconnect_timer_cb( void * p_ctx );
 
 /* Prototypes */
 static result_t buffer_init( buffer_t ** pp_buffer, uint8_t buffer_size );
@@ -233,7 +235,7 @@ static result_t _init( spils_t * p_spils, const spils_conf_t * p_conf )
 
     /* Connection timer */
     p_spils->disconnect_timeout_ms = p_conf->disconnect_timeout_ms;
-    p_spils->disconnect_timer_thres = 0;
+    memset( &p_spils->disconnect_timer, 0x00, sizeof(p_spils->disconnect_timer) );
 
     _disconnect_timer_reset( p_spils );
 
@@ -319,14 +321,31 @@ static INLINE void _event_handler( spils_t * p_spils, spils_event_type_t event_t
     p_spils->event_handler( p_spils->p_instance, event_type );
 }
 
+static void _event_deferred_cb( void * p_ctx, uint32_t arg )
+{
+    _event_handler( ( spils_t * )p_ctx, ( spils_event_type_t )arg );
+}
+
+static INLINE void _event_post( spils_t * p_spils, spils_event_type_t event_type )
+{
+    /* The events raised within the SPI interrupt are handled in the main loop */
+    defer_post( _event_deferred_cb, p_spils, event_type );
+}
+
 static INLINE void _disconnect_timer_reset( spils_t * p_spils )
 {
     if( p_spils->disconnect_timeout_ms != 0 )
     {
-        p_spils->disconnect_timer_thres = millis() + p_spils->disconnect_timeout_ms;
+        timer_start( &p_spils->disconnect_timer, p_spils->disconnect_timeout_ms, _disconnect_timer_cb, p_spils );
     }
 }
 
+static void _disconnect_timer_cb( void * p_ctx )
+{
+    /* The connection machine checks the timeout in the poll */
+    _event_handler( ( spils_t * )p_ctx, SPILS_EVENT_TYPE_POLL_REQUEST );
+}
+
 static INLINE bool_t _disconnect_timer_check( spils_t * p_spils )
 {
     if( p_spils->disconnect_timeout_ms == 0 )
@@ -335,7 +354,7 @@ static INLINE bool_t _disconnect_timer_check( spils_t * p_spils )
         return false;
     }
 
-    return ( millis() >= p_spils->disconnect_timer_thres ) ? true : false;
+    return ( timer_running( &p_spils->disconnect_timer ) == false ) ? true : false;
 }
 
 
@@ -914,7 +933,7 @@ _EXIT:
     /* Notify the new data available */
     if( transfer_result == SPIL_MESS_TYPE_RESULT_OK )
     {
-        _event_handler( p_spils, SPILS_EVENT_TYPE_DATA_IN_READY );
+        _event_post( p_spils, SPILS_EVENT_TYPE_DATA_IN_READY );
     }
 
     UNUSED(result);
@@ -1002,7 +1021,7 @@ static INLINE void _transfer_data_out_process( spils_t * p_spils, hal_mcu_spi_tr
 
     if( p_spils->state == SPILS_STATE_DATA_SENDING )
     {
-        _event_handler( p_spils, SPILS_EVENT_TYPE_DATA_OUT_SENT );
+        _event_post( p_spils, SPILS_EVENT_TYPE_DATA_OUT_SENT );
     }
 }
 
@@ -1033,10 +1052,19 @@ static void _spi_slave_buffers_set_done_handler( spils_t * p_spils )
     }
 }
 
+/*
+ * NOTE: The link machine stays within the interrupt. The response of the slave is the result of the message just
+ *       received, so it has to be composed and the SPIS re-armed before the master clocks the next transfer. Only the
+ *       events for the upper layer are deferred to the main loop.
+ */
 static void _spi_slave_transfer_done_handler( spils_t * p_spils, hal_mcu_spi_transfer_result_t * p_transfer_result )
 {
-    /* Set the connection_detected flag */
-    p_spils->connection_detected = true;
+    /* Set the connection_detected flag. The poll clears it, so there is one request per poll at most */
+    if( p_spils->connection_detected == false )
+    {
+        p_spils->connection_detected = true;
+        _event_post( p_spils, SPILS_EVENT_TYPE_POLL_REQUEST );
+    }
 
     /* Reset the INT signal - the SPI interface is not active now */
     _int_signal_reset( p_spils );
@@ -1133,7 +1161,7 @@ static INLINE void _con_state_set( spils_t * p_spils, spils_con_state_t con_stat
 {
     p_spils->con_state = con_state;
 
-    mcu_sleep_postpone();
+    mcu_wake_event_set( MCU_WAKE_SRC_SPI_LINK );
 }
 
 static INLINE void _con_state_set_connected( spils_t * p_spils )
@@ -1282,6 +1310,12 @@ _EXIT:
     /* Unlock the input stream */
     _mutex_in_unlock( p_spils );
 
+    /* The data waiting in the input cache can be moved now */
+    if( result == RESULT_OK && p_spils->line_in_busy == true )
+    {
+        _event_handler( p_spils, SPILS_EVENT_TYPE_POLL_REQUEST );
+    }
+
     return result;
 }
 
@@ -41,6 +41,8 @@ typedef enum
 
     SPILS_EVENT_TYPE_DATA_IN_READY,
     SPILS_EVENT_TYPE_DATA_OUT_SENT,
+
+    SPILS_EVENT_TYPE_POLL_REQUEST,      /* spils_poll has work to do ( the connection state or the busy input line ) */
 } spils_event_type_t;
 
 typedef void( *spils_event_handler_t )( void * p_instance, spils_event_type_t event_type );
@@ -88,6 +90,7 @@ extern bool_t spils_data_read_available( spils_t * p_spils );
 extern result_t spils_data_read( spils_t * p_spils, uint8_t * p_data, uint16_t * p_data_size );
 extern result_t spils_data_send( spils_t * p_spils, const uint8_t * p_data, uint16_t data_size );
 
+/* Needs to be called only after the SPILS_EVENT_TYPE_POLL_REQUEST event */
 extern void spils_poll( spils_t * p_spils );
 
 #ifdef __cplusplus
@@ -5,8 +5,8 @@
  * to be less than 50us or 100us due to the error caused by the delay
  * due to the execution of the code itself.
  *
- * You can set the timer used and the capture/compare unit used through
- * the corresponding #defines. You can also set the counter frequency if you wish.
+ * The hardware counter running the system timer is selected through
+ * TIME_COUNTER_LL, see Time_counter_ll.h.
  *
  * Copyright (C) 2026  Dygma Lab S.L.
  *
@@ -23,83 +23,161 @@
  * this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "nrf_drv_timer.h"
 #include "Time_counter.h"
+#include "Time_counter_ll.h"
 
-// Set parameters:
-#define TIMER_NUMBER                    4                       /* Timer used for running the system timer */
-#define TIMER_OVFLW_CHANNEL             NRF_TIMER_CC_CHANNEL0   /* CC channel used for controlling the base timer cycle and generate event when the timer rotates back to 0 */
-#define TIMER_OVFLW_INTENSET            TIMER_INTENSET_COMPARE0_Msk
-#define TIMER_OVFLW_INTENCLR            TIMER_INTENCLR_COMPARE0_Msk
-#define TIMER_OVFLW_EVENT_TYPE          NRF_TIMER_EVENT_COMPARE0
-#define TIMER_OVFLW_SHORT_CLEAR         NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK
-
-#define TIMER_COMPARE_CHANNEL           NRF_TIMER_CC_CHANNEL1   /* CC channel used for controlling the regular timeouts within the base timer cycle */
-#define TIMER_COMPARE_INTENSET          TIMER_INTENSET_COMPARE1_Msk
-#define TIMER_COMPARE_INTENCLR          TIMER_INTENCLR_COMPARE1_Msk
-#define TIMER_COMPARE_EVENT_TYPE        NRF_TIMER_EVENT_COMPARE1
-
-#define TIMER_CAPTURE_CHANNEL           NRF_TIMER_CC_CHANNEL2   /* CC channel used for reading the actual value of the timmer */
-
-#define TIMER_FREQUENCY                 NRF_TIMER_FREQ_16MHz
-#define TIMER_FREQUENCY_IN_MHZ          16
-
-#define TIMER_SYSTIM_TICK_LSB_MASK      0x7FFFFFFF              /* This is the mask of the hardware counter register value */
-#define TIMER_SYSTIM_TICK_OVFLW_VAL     0x80000000              /* The value of the tick counter if it did not overflow to 0x00000000 */
-
-#define SYSTIM_US_TO_TICK_CNT( us )     ( (systim_tick_t)us * TIMER_FREQUENCY_IN_MHZ )
+#define SYSTIM_US_TO_TICK_CNT( us )     SYSTIM_LL_US_TO_TICKS( us )
 #define SYSTIM_MS_TO_TICK_CNT( ms )     SYSTIM_US_TO_TICK_CNT( (systim_tick_t)ms * 1000 )
 
-#define SYSTIM_TICK_CNT_TO_US(ticks)    ( ticks / TIMER_FREQUENCY_IN_MHZ )
+#define SYSTIM_TICK_CNT_TO_US(ticks)    SYSTIM_LL_TICKS_TO_US( ticks )
 #define SYSTIM_TICK_CNT_TO_MS(ticks)    ( SYSTIM_TICK_CNT_TO_US( ticks ) / 1000 )
 
-#define SYSTIM_THRESHOLD_DIFFERENCE_MS_SAFE       100           //Difference between current and next time thresholds to recognize it as safe
+#define SYSTIM_THRESHOLD_DIFFERENCE_MS_SAFE       100           //Backup wake up period used only when the deadline queue has overflowed
 #define SYSTIM_THRESHOLD_DIFFERENCE_MS_MIN        1             //Minimum difference between the last time threshold and the next one
 
+#ifndef SYSTIM_DEADLINE_QUEUE_SIZE
+#define SYSTIM_DEADLINE_QUEUE_SIZE                16            //Number of different deadlines which can be pending at the same time
+#endif
+
 static bool_t initialized = false;
-static systim_tick_t systim_ticks;   //the number of ticks since the system start
+static systim_tick_t systim_ticks;   //the number of ticks since the system start, as captured by the interrupt and the critical sections
 
-static systim_tick_t systim_current_threshold;
-static systim_tick_t systim_next_threshold;
+/* Min-heap of the pending deadlines. The earliest one is always at the root and programmed in the compare unit */
+static systim_tick_t systim_deadlines[ SYSTIM_DEADLINE_QUEUE_SIZE ];
+static uint8_t systim_deadlines_count;
+static bool_t systim_deadlines_overflow;
 
 static systim_tick_t systim_difference_save;
 static systim_tick_t systim_difference_min;
 
-static nrf_drv_timer_t driver_timer = NRF_DRV_TIMER_INSTANCE(TIMER_NUMBER);
+static dl_sw_timer_t * p_sw_timers;             //the running callback timers
+static volatile bool_t sw_timers_expired;       //some of the callback timers are waiting for timer_run
 
-// Prototypes
-static void _systim_ticks_update( void );
+#if TIME_COUNTER_LL != TIME_COUNTER_LL_HOST
+static sched_task_t * p_sched_task;             //runs timer_run when some of the callback timers have expired
+#endif
 
 void _interrupt_enable( void )
 {
     ASSERT_DYGMA( initialized == true, "Systim has not been initialized yet." );
 
-    driver_timer.p_reg->INTENSET = ( TIMER_OVFLW_INTENSET | TIMER_COMPARE_INTENSET );
+    systim_ll_interrupt_enable( );
 }
 
 void _interrupt_disable( void )
 {
     ASSERT_DYGMA( initialized == true, "Systim has not been initialized yet." );
 
-    driver_timer.p_reg->INTENCLR = ( TIMER_OVFLW_INTENCLR | TIMER_COMPARE_INTENCLR );
+    systim_ll_interrupt_disable( );
 }
 
-static void _systim_ticks_update( void )
+//NOTE: This function needs to be surrounded with Interrupt Enable/Disable if it is called outside of the interrupt
+static void _systim_ticks_capture( void )
 {
-    ASSERT_DYGMA( initialized == true, "Systim has not been initialized yet." );
+    systim_ticks = systim_ll_ticks_get_isr( );
+}
 
-    //stop interrupts
-    _interrupt_disable( );
+static void _sw_timers_expired_set( void )
+{
+    sw_timers_expired = true;
 
-    uint32_t mcu_systim_ticks = nrf_drv_timer_capture( &driver_timer, TIMER_CAPTURE_CHANNEL );
+#if TIME_COUNTER_LL != TIME_COUNTER_LL_HOST
+    if ( p_sched_task != NULL )
+    {
+        sched_task_ready( p_sched_task );
+    }
+#endif
+}
 
-    //clean the LSB bits
-    systim_ticks &= ~TIMER_SYSTIM_TICK_LSB_MASK;
-    //fill the LSB bits with new value
-    systim_ticks |= ( uint32_t )mcu_systim_ticks;
+static void _systim_deadline_swap( uint8_t index_a, uint8_t index_b )
+{
+    systim_tick_t deadline = systim_deadlines[ index_a ];
 
-    //resume interrupts
-    _interrupt_enable( );
+    systim_deadlines[ index_a ] = systim_deadlines[ index_b ];
+    systim_deadlines[ index_b ] = deadline;
+}
+
+static void _systim_deadline_sift_up( uint8_t index )
+{
+    uint8_t parent;
+
+    while ( index > 0 )
+    {
+        parent = ( index - 1 ) / 2;
+
+        if ( systim_deadlines[ parent ] <= systim_deadlines[ index ] )
+            break;
+
+        _systim_deadline_swap( parent, index );
+        index = parent;
+    }
+}
+
+static void _systim_deadline_sift_down( uint8_t index )
+{
+    uint8_t child;
+
+    while ( ( child = 2 * index + 1 ) < systim_deadlines_count )
+    {
+        //take the earlier of both children
+        if ( child + 1 < systim_deadlines_count && systim_deadlines[ child + 1 ] < systim_deadlines[ child ] )
+            child++;
+
+        if ( systim_deadlines[ index ] <= systim_deadlines[ child ] )
+            break;
+
+        _systim_deadline_swap( index, child );
+        index = child;
+    }
+}
+
+//NOTE: This function needs to be surrounded with Interrupt Enable/Disable if it is called outside of the interrupt
+static void _systim_deadline_push( systim_tick_t deadline )
+{
+    uint8_t i;
+    uint8_t latest;
+
+    //the same deadline is already pending
+    for ( i = 0; i < systim_deadlines_count; i++ )
+    {
+        if ( systim_deadlines[ i ] == deadline )
+            return;
+    }
+
+    if ( systim_deadlines_count < SYSTIM_DEADLINE_QUEUE_SIZE )
+    {
+        systim_deadlines[ systim_deadlines_count ] = deadline;
+        _systim_deadline_sift_up( systim_deadlines_count );
+        systim_deadlines_count++;
+
+        return;
+    }
+
+    /*
+     * The queue is full. The latest deadline is dropped (it is always one of the leaves). The callback timers get theirs
+     * queued again by the following events and the backup wake ups let the callers re-polling timer_check do the same.
+     */
+    latest = systim_deadlines_count / 2;
+    for ( i = latest + 1; i < systim_deadlines_count; i++ )
+    {
+        if ( systim_deadlines[ i ] > systim_deadlines[ latest ] )
+            latest = i;
+    }
+
+    if ( deadline < systim_deadlines[ latest ] )
+    {
+        systim_deadlines[ latest ] = deadline;
+        _systim_deadline_sift_up( latest );
+    }
+
+    systim_deadlines_overflow = true;
+}
+
+static void _systim_deadline_pop( void )
+{
+    systim_deadlines_count--;
+    systim_deadlines[ 0 ] = systim_deadlines[ systim_deadlines_count ];
+    _systim_deadline_sift_down( 0 );
 }
 
 //NOTE: This function needs to be surrounded with Interrupt Enable/Disable if it is called outside of the interrupt
@@ -107,47 +185,56 @@ static void _systim_threshold_activate_current( void )
 {
     systim_tick_t new_threshold;
 
-    _systim_ticks_update( );
+    //check whether there is a threshold to be activated
+    if ( systim_deadlines_count == 0 )
+        return;
+
+    _systim_ticks_capture( );
 
-    new_threshold = systim_current_threshold;
+    new_threshold = systim_deadlines[ 0 ];
 
     //check whether the threshold can be activated
-    if ( systim_current_threshold == 0 )
-        return;
-    if ( systim_current_threshold <= systim_ticks + systim_difference_min )
+    if ( new_threshold <= systim_ticks + systim_difference_min )
     {
         new_threshold = systim_ticks + systim_difference_min;
     }
-    if ( ( new_threshold - systim_ticks ) >= TIMER_SYSTIM_TICK_OVFLW_VAL )
-        return;    //OVERFLOW interrupt will happen sooner
 
     //set the new threshold
-    nrf_drv_timer_compare( &driver_timer, TIMER_COMPARE_CHANNEL, ( uint32_t )( new_threshold & TIMER_SYSTIM_TICK_LSB_MASK ), true );
+    systim_ll_compare_set( systim_ticks, new_threshold );
 }
 
-static void _systim_threshold_activate_next( void )
+//NOTE: This function needs to be surrounded with Interrupt Enable/Disable if it is called outside of the interrupt
+static void _sw_timers_requeue( void )
 {
-    //compute the difference between the thresholds
-    systim_tick_t threshold_difference = systim_next_threshold - systim_current_threshold;
+    dl_sw_timer_t * p_timer;
 
-    //move the next threshold to the current threshold position
-    systim_current_threshold = systim_next_threshold;
+    //the deadlines already pending are skipped by the push
+    for ( p_timer = p_sw_timers; p_timer != NULL; p_timer = p_timer->p_next )
+    {
+        if ( p_timer->expired == false && p_timer->queued > systim_ticks )
+            _systim_deadline_push( p_timer->queued );
+    }
+}
 
-    //set the next threshold
-    if ( systim_next_threshold == 0 )
+static void _systim_threshold_activate_next( void )
+{
+    //remove all the deadlines which have already expired
+    while ( systim_deadlines_count > 0 && systim_deadlines[ 0 ] <= systim_ticks )
     {
-        // there was no valid next threshold
+        _systim_deadline_pop( );
     }
-    else if ( threshold_difference < systim_difference_save )
+
+    if ( systim_deadlines_overflow == true )
     {
-        // the threshold difference is not safe. Set backup threshold and thus wake up yet once to prevent system stuck if
-        // a former threshold gets lost in the main system loop
-        systim_next_threshold += systim_difference_save;
+        //some deadlines were dropped. The ones of the callback timers take the room made by the expired ones
+        _sw_timers_requeue( );
     }
-    else
+
+    if ( systim_deadlines_count == 0 && systim_deadlines_overflow == true )
     {
-        // the threshold difference is safe, there is no need for other threshold at this point
-        systim_next_threshold = 0;
+        // some deadlines were dropped. Wake up yet once to let the main system loop queue them again
+        systim_deadlines_overflow = false;
+        _systim_deadline_push( systim_ticks + systim_difference_save );
     }
 
     _systim_threshold_activate_current( );
@@ -160,88 +247,163 @@ static void _systim_threshold_set( const dl_timer_t * p_timer )
     if ( *p_timer <= systim_ticks )
         return;
 
-    //compare the new threshold with the current active one
-    if ( ( systim_current_threshold == 0 ) || *p_timer < systim_current_threshold )
-    {
+    _systim_deadline_push( *p_timer );
 
-        //shift the current threshold to the "next" position
-        systim_next_threshold = systim_current_threshold;
-        //set new "current" threshold
-        systim_current_threshold = *p_timer;
-        //activate the current threshold
+    //reprogram the compare unit only if the new deadline is the earliest one
+    if ( systim_deadlines[ 0 ] == *p_timer )
+    {
         _systim_threshold_activate_current( );
     }
-    else if ( *p_timer != systim_current_threshold && *p_timer < systim_next_threshold )
+}
+
+//NOTE: This function needs to be surrounded with Interrupt Enable/Disable if it is called outside of the interrupt
+static void _sw_timers_expire( void )
+{
+    dl_sw_timer_t * p_timer;
+
+    for ( p_timer = p_sw_timers; p_timer != NULL; p_timer = p_timer->p_next )
+    {
+        if ( p_timer->expired == true )
+            continue;
+
+        if ( p_timer->deadline <= systim_ticks )
+        {
+            p_timer->expired = true;
+            _sw_timers_expired_set( );
+        }
+        else if ( p_timer->queued <= systim_ticks )
+        {
+            //the timer was restarted after its deadline had been queued, queue the new one now
+            p_timer->queued = p_timer->deadline;
+            _systim_deadline_push( p_timer->queued );
+        }
+    }
+}
+
+//NOTE: This function needs to be surrounded with Interrupt Enable/Disable if it is called outside of the interrupt
+static void _sw_timer_unlink( dl_sw_timer_t * p_timer )
+{
+    dl_sw_timer_t ** pp_timer = &p_sw_timers;
+
+    while ( *pp_timer != NULL )
     {
-        //set new "next" threshold. (forget the previous one)
-        systim_next_threshold = *p_timer;
+        if ( *pp_timer == p_timer )
+        {
+            *pp_timer = p_timer->p_next;
+            break;
+        }
+
+        pp_timer = &( *pp_timer )->p_next;
     }
+
+    p_timer->p_next = NULL;
+    p_timer->running = false;
+    p_timer->expired = false;
 }
 
-static void _timer_set_threshold( dl_timer_t * p_timer, systim_tick_t threshold )
+static void _sw_timer_start( dl_sw_timer_t * p_timer, systim_tick_t ticks, systim_tick_t period, dl_timer_cb_t cb, void * p_ctx )
 {
     //stop interrupts
     _interrupt_disable( );
 
-    *p_timer = threshold;
+    _systim_ticks_capture( );
+
+    p_timer->deadline = systim_ticks + ticks;
+    p_timer->period = period;
+    p_timer->cb = cb;
+    p_timer->p_ctx = p_ctx;
+    p_timer->expired = false;
+
+    if ( p_timer->running == false )
+    {
+        p_timer->running = true;
+
+        p_timer->p_next = p_sw_timers;
+        p_sw_timers = p_timer;
+    }
+    else if ( p_timer->queued > systim_ticks && p_timer->queued <= p_timer->deadline )
+    {
+        /*
+         * The restarted timer still has a sooner deadline in the queue. The new one is queued once that one is
+         * reached, so the timers restarted very often (e.g. the link timeouts) do not fill up the queue.
+         */
+        _interrupt_enable( );
+        return;
+    }
+
+    if ( ticks == 0 )
+    {
+        //there is no deadline to wait for
+        p_timer->expired = true;
+        _sw_timers_expired_set( );
+    }
+
+    p_timer->queued = p_timer->deadline;
+    _systim_threshold_set( &p_timer->queued );
 
     //resume interrupts
     _interrupt_enable( );
+}
 
-    //update the system ticks value
-    _systim_ticks_update( );
-
+static void _timer_set_threshold( dl_timer_t * p_timer, systim_tick_t threshold )
+{
     //stop interrupts
     _interrupt_disable( );
+
+    *p_timer = threshold;
+
+    //update the system ticks value
+    _systim_ticks_capture( );
     //try to set new threshold
     _systim_threshold_set( p_timer );
+
     //resume interrupts
     _interrupt_enable( );
 }
 
 static void _timer_set_ticks( dl_timer_t * p_timer, systim_tick_t ticks )
 {
-    systim_tick_t threshold;
-
-    _systim_ticks_update( );
-
-    //stop interrupts
-    _interrupt_disable( );
-
     //compute the target threshold value in number of ticks
-    threshold = systim_ticks + ticks;
-
-    //resume interrupts
-    _interrupt_enable( );
+    systim_tick_t threshold = systim_ll_ticks_get( ) + ticks;
 
     _timer_set_threshold( p_timer, threshold );
 }
 
-// Handler for driver_timer events.
-static void _nrf_drv_event_handler(nrf_timer_event_t event_type, void *p_context)
+#if TIME_COUNTER_LL != TIME_COUNTER_LL_HOST
+static void _sched_task_run_cb( void * p_instance )
 {
-    switch( event_type )
-    {
-        case TIMER_COMPARE_EVENT_TYPE:
-
-            _systim_ticks_update( );
-            _systim_threshold_activate_next( );
-
-            break;
+    UNUSED( p_instance );
 
-        case TIMER_OVFLW_EVENT_TYPE:
-
-            systim_ticks &= ~TIMER_SYSTIM_TICK_LSB_MASK;
-            systim_ticks += TIMER_SYSTIM_TICK_OVFLW_VAL;
-
-            break;
-
-        default:
+    timer_run( );
+}
 
-            ASSERT_DYGMA( false, "Unknown systim HAL event not handled." );
+static void _sched_task_init( void )
+{
+    result_t result = RESULT_ERR;
+    sched_task_conf_t config;
+
+    /* The callbacks go right after the deferred interrupt work */
+    config.p_name = "timer";
+    config.p_instance = NULL;
+    config.run = _sched_task_run_cb;
+
+    config.prio = SCHED_PRIO_HIGH;
+    config.poll = false;
+    config.wake = false;
+    config.budget_us = 0;
+
+    result = sched_task_add( &p_sched_task, &config );
+    ASSERT_DYGMA( result == RESULT_OK, "sched_task_add failed" );
+    UNUSED( result );
+}
+#endif
 
-            break;
-    }
+// Handler for the compare and the counter rotation events.
+static void _systim_event_handler( void )
+{
+    _systim_ticks_capture( );
+    _sw_timers_expire( );
+    _systim_threshold_activate_next( );
 }
 
 /*
@@ -260,46 +422,37 @@ void timer_counter_init(uint32_t micros_resolution_)
     /* Initialize the system_ticks */
     systim_ticks = 0;
 
-    systim_current_threshold = 0;
-    systim_next_threshold = 0;
+    systim_deadlines_count = 0;
+    systim_deadlines_overflow = false;
+
+    p_sw_timers = NULL;
+    sw_timers_expired = false;
 
     systim_difference_save = SYSTIM_MS_TO_TICK_CNT( SYSTIM_THRESHOLD_DIFFERENCE_MS_SAFE );
     systim_difference_min = SYSTIM_MS_TO_TICK_CNT( SYSTIM_THRESHOLD_DIFFERENCE_MS_MIN );
 
-    nrf_drv_timer_config_t timer_config;
-
-    /*
-        The "frequency" parameter here is actually the prescaler value, and the
-        timer runs at the following frequency: f = 16MHz / 2^prescaler.
-    */
-    timer_config.frequency = TIMER_FREQUENCY;
-    timer_config.mode = NRF_TIMER_MODE_TIMER;        // NRF_TIMER_MODE_COUNTER
-    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32; // NRF_TIMER_BIT_WIDTH_8, NRF_TIMER_BIT_WIDTH_16, NRF_TIMER_BIT_WIDTH_24, NRF_TIMER_BIT_WIDTH_32
-    timer_config.interrupt_priority = APP_IRQ_PRIORITY_LOW_MID;
-    timer_config.p_context = NULL;
+    systim_ll_init( _systim_event_handler );
 
-    ret_code_t ret = nrf_drv_timer_init(&driver_timer, &timer_config, _nrf_drv_event_handler);
-    APP_ERROR_CHECK(ret);
-
-    nrf_drv_timer_extended_compare(&driver_timer, TIMER_OVFLW_CHANNEL, TIMER_SYSTIM_TICK_OVFLW_VAL, TIMER_OVFLW_SHORT_CLEAR, true);
-
-    nrf_drv_timer_enable(&driver_timer);
+#if TIME_COUNTER_LL != TIME_COUNTER_LL_HOST
+    /* Let the sleep control know about the next wake up */
+    mcu_sleep_deadline_source_set( timer_next_deadline_get );
+    /* The time of the scheduler budgets */
+    sched_time_source_set( timer_counter_get_micros );
+    /* The callback timers are run by the scheduler */
+    _sched_task_init( );
+#endif
 
     initialized = true;
 }
 
 systim_tick_t timer_counter_get_micros(void)
 {
-    _systim_ticks_update( );
-
-    return SYSTIM_TICK_CNT_TO_US( systim_ticks );
+    return SYSTIM_TICK_CNT_TO_US( systim_ll_ticks_get( ) );
 }
 
 uint32_t timer_counter_get_millis(void)
 {
-    _systim_ticks_update( );
-
-    return SYSTIM_TICK_CNT_TO_MS( systim_ticks );
+    return SYSTIM_TICK_CNT_TO_MS( systim_ll_ticks_get( ) );
 }
 
 void timer_set_ms( dl_timer_t * p_timer, uint32_t ms )
@@ -320,11 +473,17 @@ bool timer_check( dl_timer_t * p_timer )
 {
     bool ret_val = false;
 
-    _systim_ticks_update( );
+    //the expired timers do not need to touch the interrupts
+    if ( *p_timer <= systim_ll_ticks_get( ) )
+    {
+        return true;
+    }
 
     //stop interrupts
     _interrupt_disable( );
 
+    _systim_ticks_capture( );
+
     if ( *p_timer <= systim_ticks )
     {
         ret_val = true;
@@ -340,3 +499,131 @@ bool timer_check( dl_timer_t * p_timer )
 
     return ret_val;
 }
+
+void timer_start( dl_sw_timer_t * p_timer, uint32_t ms, dl_timer_cb_t cb, void * p_ctx )
+{
+    _sw_timer_start( p_timer, SYSTIM_MS_TO_TICK_CNT( ms ), 0, cb, p_ctx );
+}
+
+void timer_start_periodic( dl_sw_timer_t * p_timer, uint32_t ms, dl_timer_cb_t cb, void * p_ctx )
+{
+    ASSERT_DYGMA( ms > 0, "The period of a periodic timer cannot be zero" );
+
+    _sw_timer_start( p_timer, SYSTIM_MS_TO_TICK_CNT( ms ), SYSTIM_MS_TO_TICK_CNT( ms ), cb, p_ctx );
+}
+
+void timer_stop( dl_sw_timer_t * p_timer )
+{
+    //stop interrupts
+    _interrupt_disable( );
+
+    /* Its deadline stays in the queue and just causes one wake up */
+    if ( p_timer->running == true )
+    {
+        _sw_timer_unlink( p_timer );
+    }
+
+    //resume interrupts
+    _interrupt_enable( );
+}
+
+bool timer_running( const dl_sw_timer_t * p_timer )
+{
+    return p_timer->running;
+}
+
+void timer_run( void )
+{
+    dl_sw_timer_t * p_timer;
+    dl_timer_cb_t cb;
+    void * p_ctx;
+    bool_t found;
+
+    if ( sw_timers_expired == false )
+    {
+        return;
+    }
+
+    sw_timers_expired = false;
+
+    /* Take the expired timers one by one, as the callbacks are free to start and stop any timer */
+    do
+    {
+        found = false;
+
+        //stop interrupts
+        _interrupt_disable( );
+
+        for ( p_timer = p_sw_timers; p_timer != NULL; p_timer = p_timer->p_next )
+        {
+            if ( p_timer->expired == false )
+                continue;
+
+            found = true;
+            cb = p_timer->cb;
+            p_ctx = p_timer->p_ctx;
+
+            if ( p_timer->period == 0 )
+            {
+                _sw_timer_unlink( p_timer );
+                break;
+            }
+
+            //reload the periodic timer, skipping the periods which have already been missed
+            _systim_ticks_capture( );
+
+            p_timer->expired = false;
+            p_timer->deadline += p_timer->period;
+            if ( p_timer->deadline <= systim_ticks )
+            {
+                p_timer->deadline = systim_ticks + p_timer->period;
+            }
+
+            p_timer->queued = p_timer->deadline;
+            _systim_threshold_set( &p_timer->queued );
+            break;
+        }
+
+        //resume interrupts
+        _interrupt_enable( );
+
+        if ( found == true && cb != NULL )
+        {
+            cb( p_ctx );
+        }
+    } while ( found == true );
+}
+
+bool timer_next_deadline_get( uint32_t * p_us )
+{
+    bool ret_val = true;
+    systim_tick_t time_left = 0;
+
+    //stop interrupts
+    _interrupt_disable( );
+
+    if ( sw_timers_expired == true )
+    {
+        //the callbacks waiting for timer_run are due right now
+    }
+    else if ( systim_deadlines_count == 0 )
+    {
+        ret_val = false;
+    }
+    else
+    {
+        _systim_ticks_capture( );
+
+        if ( systim_deadlines[ 0 ] > systim_ticks )
+        {
+            time_left = SYSTIM_TICK_CNT_TO_US( systim_deadlines[ 0 ] - systim_ticks );
+        }
+    }
+
+    //resume interrupts
+    _interrupt_enable( );
+
+    *p_us = ( time_left > UINT32_MAX ) ? UINT32_MAX : ( uint32_t )time_left;
+
+    return ret_val;
+}
@@ -5,8 +5,8 @@
  * to be less than 50us or 100us due to the error caused by the delay
  * due to the execution of the code itself.
  *
- * You can set the timer used and the capture/compare unit used through
- * the corresponding #defines. You can also set the counter frequency if you wish.
+ * The hardware counter running the system timer is selected through
+ * TIME_COUNTER_LL, see Time_counter_ll.h.
  *
  * The MIT License (MIT)
  *
@@ -44,6 +44,21 @@ extern "C"
 typedef uint64_t systim_tick_t;
 typedef systim_tick_t dl_timer_t;
 
+typedef void (*dl_timer_cb_t)( void * p_ctx );
+
+typedef struct dl_sw_timer dl_sw_timer_t;
+struct dl_sw_timer
+{
+    dl_timer_t deadline;
+    systim_tick_t period;           /* Zero for the one-shot timers */
+    dl_timer_cb_t cb;
+    void * p_ctx;
+    dl_timer_t queued;              /* The deadline of this timer in the deadline queue */
+    bool_t running;
+    volatile bool_t expired;
+    dl_sw_timer_t * p_next;
+};
+
 void timer_counter_init(uint32_t micros_resolution);
 systim_tick_t timer_counter_get_micros(void);
 uint32_t timer_counter_get_millis(void);
@@ -52,6 +67,21 @@ void timer_set_ms( dl_timer_t * p_timer, uint32_t ms );
 void timer_set_us( dl_timer_t * p_timer, uint32_t us );
 bool timer_check( dl_timer_t * p_timer );
 
+/*
+ * Callback timers. The interrupt only marks the expired timers and the callbacks are called from timer_run, which is
+ * run by a high priority scheduler task made ready by the interrupt, so sched_run in the main loop is enough ( with the
+ * host backend it has to be called directly ). Starting a running timer restarts it. A NULL callback only wakes the
+ * system up.
+ */
+void timer_start( dl_sw_timer_t * p_timer, uint32_t ms, dl_timer_cb_t cb, void * p_ctx );
+void timer_start_periodic( dl_sw_timer_t * p_timer, uint32_t ms, dl_timer_cb_t cb, void * p_ctx );
+void timer_stop( dl_sw_timer_t * p_timer );
+bool timer_running( const dl_sw_timer_t * p_timer );
+void timer_run( void );
+
+/* Returns false if there is no deadline pending. Otherwise the time left to the earliest one, in microseconds */
+bool timer_next_deadline_get( uint32_t * p_us );
+
 #ifdef __cplusplus
 }
 #endif
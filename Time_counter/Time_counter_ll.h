@@ -0,0 +1,80 @@
+/*
+ * Time Counter low level -- Interface to the hardware counter running the
+ * system timer. Select the backend through TIME_COUNTER_LL.
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TIME_COUNTER_LL_H_
+#define __TIME_COUNTER_LL_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "Time_counter.h"
+
+#define TIME_COUNTER_LL_TIMER           0       /* TIMER4 at 16 MHz. It keeps the HFCLK running */
+#define TIME_COUNTER_LL_RTC             1       /* RTC2 at 32.768 kHz on the LFCLK. 30.5us resolution */
+#define TIME_COUNTER_LL_HOST            2       /* Virtual clock driven by the host, see Time_counter_ll_host.h */
+
+#ifndef TIME_COUNTER_LL
+#define TIME_COUNTER_LL                 TIME_COUNTER_LL_TIMER
+#endif
+
+#if TIME_COUNTER_LL == TIME_COUNTER_LL_TIMER
+#define SYSTIM_LL_US_TO_TICKS( us )         ( (systim_tick_t)( us ) * 16 )
+#define SYSTIM_LL_TICKS_TO_US( ticks )      ( (systim_tick_t)( ticks ) / 16 )
+#elif TIME_COUNTER_LL == TIME_COUNTER_LL_RTC
+/* 1000000 / 32768 = 15625 / 512. The timeouts are rounded up so they never expire sooner */
+#define SYSTIM_LL_US_TO_TICKS( us )         ( ( (systim_tick_t)( us ) * 512 + 15624 ) / 15625 )
+#define SYSTIM_LL_TICKS_TO_US( ticks )      ( ( (systim_tick_t)( ticks ) * 15625 ) / 512 )
+#elif TIME_COUNTER_LL == TIME_COUNTER_LL_HOST
+#define SYSTIM_LL_US_TO_TICKS( us )         ( (systim_tick_t)( us ) )
+#define SYSTIM_LL_TICKS_TO_US( ticks )      ( (systim_tick_t)( ticks ) )
+#else
+#error "Unknown TIME_COUNTER_LL backend"
+#endif
+
+typedef void (*systim_ll_event_handler_t)( void );
+
+/* The event handler is called from the interrupt when the compare is reached and at every rotation of the counter */
+extern void systim_ll_init( systim_ll_event_handler_t event_handler );
+
+/* Lock-free read of the ticks since the system start. It can be called from any context */
+extern systim_tick_t systim_ll_ticks_get( void );
+/* The same for the event handler and the critical sections */
+extern systim_tick_t systim_ll_ticks_get_isr( void );
+
+/* Arms the compare for the deadline. A deadline out of the counter range waits for the next rotation */
+extern void systim_ll_compare_set( systim_tick_t ticks, systim_tick_t deadline );
+
+extern void systim_ll_interrupt_enable( void );
+extern void systim_ll_interrupt_disable( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TIME_COUNTER_LL_H_
@@ -0,0 +1,128 @@
+/*
+ * Time Counter low level -- Virtual clock backend for the host. One tick is
+ * one microsecond.
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Time_counter_ll.h"
+
+#if TIME_COUNTER_LL == TIME_COUNTER_LL_HOST
+
+#include "Time_counter_ll_host.h"
+
+static systim_tick_t host_ticks;
+static systim_tick_t host_compare;
+static bool_t host_compare_armed;
+static bool_t host_interrupt_enabled;
+
+static systim_ll_event_handler_t systim_event_handler;
+
+static systim_ll_host_stats_t host_stats;
+
+void systim_ll_init( systim_ll_event_handler_t event_handler )
+{
+    host_ticks = 0;
+    host_compare_armed = false;
+    host_interrupt_enabled = true;
+
+    systim_event_handler = event_handler;
+
+    systim_ll_host_stats_reset( );
+}
+
+systim_tick_t systim_ll_ticks_get( void )
+{
+    return host_ticks;
+}
+
+systim_tick_t systim_ll_ticks_get_isr( void )
+{
+    return host_ticks;
+}
+
+void systim_ll_compare_set( systim_tick_t ticks, systim_tick_t deadline )
+{
+    UNUSED( ticks );
+
+    /* There is no counter rotation, every deadline can be armed */
+    host_compare = deadline;
+    host_compare_armed = true;
+}
+
+void systim_ll_interrupt_enable( void )
+{
+    host_interrupt_enabled = true;
+}
+
+void systim_ll_interrupt_disable( void )
+{
+    host_interrupt_enabled = false;
+}
+
+void systim_ll_host_advance_us( uint64_t us )
+{
+    systim_tick_t target = host_ticks + us;
+
+    ASSERT_DYGMA( host_interrupt_enabled == true, "The virtual clock cannot move inside a critical section" );
+
+    while ( host_compare_armed == true && host_compare <= target )
+    {
+        host_ticks = host_compare;
+        host_compare_armed = false;
+
+        host_stats.event_count++;
+        systim_event_handler( );
+    }
+
+    host_ticks = target;
+}
+
+bool_t systim_ll_host_advance_to_next( void )
+{
+    systim_tick_t idle_time;
+
+    if ( host_compare_armed == false )
+    {
+        return false;
+    }
+
+    idle_time = ( host_compare > host_ticks ) ? host_compare - host_ticks : 0;
+    host_stats.idle_time_us += idle_time;
+
+    systim_ll_host_advance_us( idle_time );
+
+    return true;
+}
+
+bool_t systim_ll_host_next_deadline_get( systim_tick_t * p_deadline )
+{
+    *p_deadline = host_compare;
+
+    return host_compare_armed;
+}
+
+const systim_ll_host_stats_t * systim_ll_host_stats_get( void )
+{
+    return &host_stats;
+}
+
+void systim_ll_host_stats_reset( void )
+{
+    host_stats.event_count = 0;
+    host_stats.idle_time_us = 0;
+}
+
+#endif /* TIME_COUNTER_LL == TIME_COUNTER_LL_HOST */
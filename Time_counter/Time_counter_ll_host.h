@@ -0,0 +1,85 @@
+/*
+ * Time Counter low level -- Virtual clock backend for the host.
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TIME_COUNTER_LL_HOST_H_
+#define __TIME_COUNTER_LL_HOST_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "Time_counter_ll.h"
+
+#if TIME_COUNTER_LL == TIME_COUNTER_LL_HOST
+
+/*
+ * The virtual clock only moves when the host tells it to. Every compare reached on the way is served in order, as the
+ * timer interrupt would do, so long idle scenarios can be run as fast as the host executes them. There is no scheduler
+ * on the host, so timer_run has to be called afterwards to run the callback timers. Select this backend with
+ * -DTIME_COUNTER_LL=2 (TIME_COUNTER_LL_HOST), not by defining TIME_COUNTER_LL_HOST itself.
+ *
+ * E.g. 8 hours of idle with a periodic 1.5 s timer, a 2 s save timer and a 3.1 s grace timeout polled by timer_check:
+ *
+ *     timer_counter_init( 0 );
+ *     timer_start( &save_timer, 2000, save_cb, NULL );
+ *     timer_start_periodic( &poll_timer, 1500, poll_cb, NULL );
+ *     timer_set_ms( &grace, 3100 );
+ *
+ *     while ( timer_counter_get_millis() < 8UL * 3600 * 1000 && systim_ll_host_advance_to_next() )
+ *     {
+ *         timer_run();
+ *     }
+ *
+ * It runs in a few milliseconds. The save fires once, the poll 19200 times and timer_check( &grace ) is true at the
+ * end. The stats show 19202 wake ups, one per callback deadline plus one for the grace deadline, and the whole 8 hours
+ * as idle time. A polled timeout wakes the system once when it is reached, unless it coincides with another deadline
+ * (e.g. a 3000 ms grace falls on the second poll and gives 19201 wake ups).
+ */
+
+typedef struct
+{
+    uint32_t event_count;           /* Compare events served, i.e. the wake ups of the system timer */
+    uint64_t idle_time_us;          /* Time jumped over by systim_ll_host_advance_to_next */
+} systim_ll_host_stats_t;
+
+/* Moves the clock forward, serving the compares in between */
+extern void systim_ll_host_advance_us( uint64_t us );
+/* Moves the clock to the armed compare and serves it. Returns false if there was no compare armed */
+extern bool_t systim_ll_host_advance_to_next( void );
+/* Returns false if there is no compare armed */
+extern bool_t systim_ll_host_next_deadline_get( systim_tick_t * p_deadline );
+
+extern const systim_ll_host_stats_t * systim_ll_host_stats_get( void );
+extern void systim_ll_host_stats_reset( void );
+
+#endif /* TIME_COUNTER_LL == TIME_COUNTER_LL_HOST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TIME_COUNTER_LL_HOST_H_
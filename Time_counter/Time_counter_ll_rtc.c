@@ -0,0 +1,147 @@
+/*
+ * Time Counter low level -- System timer running on RTC2 at 32.768 kHz.
+ *
+ * The RTC runs on the LFCLK, so the HFCLK is not kept running by the system
+ * timer while the keyboard is idle. The resolution is 30.5us.
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Time_counter_ll.h"
+
+#if TIME_COUNTER_LL == TIME_COUNTER_LL_RTC
+
+#include "nrf_drv_rtc.h"
+#include "nrf_drv_clock.h"
+
+// Set parameters:
+#define RTC_NUMBER                      2                       /* RTC used for running the system timer. RTC0 is used by the SoftDevice and RTC1 by app_timer */
+#define RTC_COMPARE_CHANNEL             0                       /* CC channel used for controlling the regular timeouts within the counter cycle */
+#define RTC_INT_MASK                    ( NRF_RTC_INT_COMPARE0_MASK | NRF_RTC_INT_OVERFLOW_MASK )
+
+#define RTC_SYSTIM_TICK_LSB_MASK        0x00FFFFFF              /* The RTC counter is 24 bits wide */
+#define RTC_SYSTIM_TICK_OVFLW_VAL       0x01000000
+
+static volatile uint32_t systim_cycles;   //the number of completed counter cycles. Only written by the overflow interrupt
+static systim_ll_event_handler_t systim_event_handler;
+
+static const nrf_drv_rtc_t driver_rtc = NRF_DRV_RTC_INSTANCE(RTC_NUMBER);
+
+/*
+ * Lock-free read of the ticks. The COUNTER register can be read directly from any context, the read is retried if the
+ * overflow interrupt comes in the meantime and a rotation whose interrupt is still pending is counted in.
+ */
+static systim_tick_t _ticks_read( void )
+{
+    uint32_t cycles;
+    uint32_t counter;
+    bool_t overflow_pending;
+
+    do
+    {
+        cycles = systim_cycles;
+
+        counter = nrf_rtc_counter_get( driver_rtc.p_reg );
+        overflow_pending = ( nrf_rtc_event_pending( driver_rtc.p_reg, NRF_RTC_EVENT_OVERFLOW ) == true ) &&
+                           ( counter < RTC_SYSTIM_TICK_OVFLW_VAL / 2 );
+    } while ( cycles != systim_cycles );
+
+    return ( (systim_tick_t)cycles + overflow_pending ) * RTC_SYSTIM_TICK_OVFLW_VAL + counter;
+}
+
+// Handler for driver_rtc events.
+static void _nrf_drv_event_handler( nrf_drv_rtc_int_type_t int_type )
+{
+    switch( int_type )
+    {
+        case NRF_DRV_RTC_INT_COMPARE0:
+
+            systim_event_handler( );
+
+            break;
+
+        case NRF_DRV_RTC_INT_OVERFLOW:
+
+            systim_cycles++;
+
+            //the earliest deadline may fall into the new cycle
+            systim_event_handler( );
+
+            break;
+
+        default:
+
+            ASSERT_DYGMA( false, "Unknown systim HAL event not handled." );
+
+            break;
+    }
+}
+
+void systim_ll_init( systim_ll_event_handler_t event_handler )
+{
+    ret_code_t ret;
+    nrf_drv_rtc_config_t rtc_config = NRF_DRV_RTC_DEFAULT_CONFIG;
+
+    systim_cycles = 0;
+    systim_event_handler = event_handler;
+
+    /* The LFCLK may not be started by the SoftDevice yet */
+    ret = nrf_drv_clock_init();
+    if ( ret != NRF_ERROR_MODULE_ALREADY_INITIALIZED )
+    {
+        APP_ERROR_CHECK(ret);
+    }
+    nrf_drv_clock_lfclk_request( NULL );
+
+    rtc_config.prescaler = RTC_FREQ_TO_PRESCALER( 32768 );
+    rtc_config.interrupt_priority = APP_IRQ_PRIORITY_LOW_MID;
+
+    ret = nrf_drv_rtc_init( &driver_rtc, &rtc_config, _nrf_drv_event_handler );
+    APP_ERROR_CHECK(ret);
+
+    nrf_drv_rtc_overflow_enable( &driver_rtc, true );
+
+    nrf_drv_rtc_enable( &driver_rtc );
+}
+
+systim_tick_t systim_ll_ticks_get( void )
+{
+    return _ticks_read( );
+}
+
+systim_tick_t systim_ll_ticks_get_isr( void )
+{
+    return _ticks_read( );
+}
+
+void systim_ll_compare_set( systim_tick_t ticks, systim_tick_t deadline )
+{
+    if ( ( deadline - ticks ) >= RTC_SYSTIM_TICK_OVFLW_VAL )
+        return;    //OVERFLOW interrupt will happen sooner
+
+    nrf_drv_rtc_cc_set( &driver_rtc, RTC_COMPARE_CHANNEL, ( uint32_t )( deadline & RTC_SYSTIM_TICK_LSB_MASK ), true );
+}
+
+void systim_ll_interrupt_enable( void )
+{
+    nrf_rtc_int_enable( driver_rtc.p_reg, RTC_INT_MASK );
+}
+
+void systim_ll_interrupt_disable( void )
+{
+    nrf_rtc_int_disable( driver_rtc.p_reg, RTC_INT_MASK );
+}
+
+#endif /* TIME_COUNTER_LL == TIME_COUNTER_LL_RTC */
@@ -0,0 +1,155 @@
+/*
+ * Time Counter low level -- System timer running on TIMER4 at 16 MHz.
+ *
+ * Copyright (C) 2026  Dygma Lab S.L.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Time_counter_ll.h"
+
+#if TIME_COUNTER_LL == TIME_COUNTER_LL_TIMER
+
+#include "nrf_drv_timer.h"
+
+// Set parameters:
+#define TIMER_NUMBER                    4                       /* Timer used for running the system timer */
+#define TIMER_OVFLW_CHANNEL             NRF_TIMER_CC_CHANNEL0   /* CC channel used for controlling the base timer cycle and generate event when the timer rotates back to 0 */
+#define TIMER_OVFLW_INTENSET            TIMER_INTENSET_COMPARE0_Msk
+#define TIMER_OVFLW_INTENCLR            TIMER_INTENCLR_COMPARE0_Msk
+#define TIMER_OVFLW_EVENT_TYPE          NRF_TIMER_EVENT_COMPARE0
+#define TIMER_OVFLW_SHORT_CLEAR         NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK
+
+#define TIMER_COMPARE_CHANNEL           NRF_TIMER_CC_CHANNEL1   /* CC channel used for controlling the regular timeouts within the base timer cycle */
+#define TIMER_COMPARE_INTENSET          TIMER_INTENSET_COMPARE1_Msk
+#define TIMER_COMPARE_INTENCLR          TIMER_INTENCLR_COMPARE1_Msk
+#define TIMER_COMPARE_EVENT_TYPE        NRF_TIMER_EVENT_COMPARE1
+
+#define TIMER_CAPTURE_CHANNEL           NRF_TIMER_CC_CHANNEL2   /* CC channel used for reading the actual value of the timmer */
+#define TIMER_ISR_CAPTURE_CHANNEL       NRF_TIMER_CC_CHANNEL3   /* CC channel used for reading the actual value of the timmer from the interrupt and the critical sections */
+
+#define TIMER_FREQUENCY                 NRF_TIMER_FREQ_16MHz
+
+#define TIMER_SYSTIM_TICK_LSB_MASK      0x7FFFFFFF              /* This is the mask of the hardware counter register value */
+#define TIMER_SYSTIM_TICK_OVFLW_VAL     0x80000000              /* The value of the tick counter if it did not overflow to 0x00000000 */
+
+static volatile uint32_t systim_cycles;   //the number of completed counter cycles. Only written by the overflow interrupt
+static systim_ll_event_handler_t systim_event_handler;
+
+static nrf_drv_timer_t driver_timer = NRF_DRV_TIMER_INSTANCE(TIMER_NUMBER);
+
+/*
+ * Lock-free read of the ticks. The capture is retried if the overflow interrupt comes in the meantime, and a counter
+ * rotation whose interrupt is still pending is counted in. Each context level has its own capture channel, so the
+ * interrupt cannot overwrite the capture of the code it preempts.
+ */
+static systim_tick_t _ticks_read( nrf_timer_cc_channel_t channel )
+{
+    uint32_t cycles;
+    uint32_t counter;
+    bool_t overflow_pending;
+
+    do
+    {
+        cycles = systim_cycles;
+
+        counter = nrf_drv_timer_capture( &driver_timer, channel );
+        overflow_pending = ( nrf_timer_event_check( driver_timer.p_reg, TIMER_OVFLW_EVENT_TYPE ) == true ) &&
+                           ( counter < TIMER_SYSTIM_TICK_OVFLW_VAL / 2 );
+    } while ( cycles != systim_cycles );
+
+    return ( (systim_tick_t)cycles + overflow_pending ) * TIMER_SYSTIM_TICK_OVFLW_VAL + counter;
+}
+
+// Handler for driver_timer events.
+static void _nrf_drv_event_handler(nrf_timer_event_t event_type, void *p_context)
+{
+    switch( event_type )
+    {
+        case TIMER_COMPARE_EVENT_TYPE:
+
+            systim_event_handler( );
+
+            break;
+
+        case TIMER_OVFLW_EVENT_TYPE:
+
+            systim_cycles++;
+
+            //the earliest deadline may fall into the new cycle
+            systim_event_handler( );
+
+            break;
+
+        default:
+
+            ASSERT_DYGMA( false, "Unknown systim HAL event not handled." );
+
+            break;
+    }
+}
+
+void systim_ll_init( systim_ll_event_handler_t event_handler )
+{
+    systim_cycles = 0;
+    systim_event_handler = event_handler;
+
+    nrf_drv_timer_config_t timer_config;
+
+    /*
+        The "frequency" parameter here is actually the prescaler value, and the
+        timer runs at the following frequency: f = 16MHz / 2^prescaler.
+    */
+    timer_config.frequency = TIMER_FREQUENCY;
+    timer_config.mode = NRF_TIMER_MODE_TIMER;        // NRF_TIMER_MODE_COUNTER
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32; // NRF_TIMER_BIT_WIDTH_8, NRF_TIMER_BIT_WIDTH_16, NRF_TIMER_BIT_WIDTH_24, NRF_TIMER_BIT_WIDTH_32
+    timer_config.interrupt_priority = APP_IRQ_PRIORITY_LOW_MID;
+    timer_config.p_context = NULL;
+
+    ret_code_t ret = nrf_drv_timer_init(&driver_timer, &timer_config, _nrf_drv_event_handler);
+    APP_ERROR_CHECK(ret);
+
+    nrf_drv_timer_extended_compare(&driver_timer, TIMER_OVFLW_CHANNEL, TIMER_SYSTIM_TICK_OVFLW_VAL, TIMER_OVFLW_SHORT_CLEAR, true);
+
+    nrf_drv_timer_enable(&driver_timer);
+}
+
+systim_tick_t systim_ll_ticks_get( void )
+{
+    return _ticks_read( TIMER_CAPTURE_CHANNEL );
+}
+
+systim_tick_t systim_ll_ticks_get_isr( void )
+{
+    return _ticks_read( TIMER_ISR_CAPTURE_CHANNEL );
+}
+
+void systim_ll_compare_set( systim_tick_t ticks, systim_tick_t deadline )
+{
+    if ( ( deadline - ticks ) >= TIMER_SYSTIM_TICK_OVFLW_VAL )
+        return;    //OVERFLOW interrupt will happen sooner
+
+    nrf_drv_timer_compare( &driver_timer, TIMER_COMPARE_CHANNEL, ( uint32_t )( deadline & TIMER_SYSTIM_TICK_LSB_MASK ), true );
+}
+
+void systim_ll_interrupt_enable( void )
+{
+    driver_timer.p_reg->INTENSET = ( TIMER_OVFLW_INTENSET | TIMER_COMPARE_INTENSET );
+}
+
+void systim_ll_interrupt_disable( void )
+{
+    driver_timer.p_reg->INTENCLR = ( TIMER_OVFLW_INTENCLR | TIMER_COMPARE_INTENCLR );
+}
+
+#endif /* TIME_COUNTER_LL == TIME_COUNTER_LL_TIMER */
@@ -58,6 +58,10 @@ static bool flag_transfer_completed = false;
 static bool flag_rx_completed = false;
 static bool flag_tx_completed = false;
 
+/*
+ * NOTE: This handler is not deferred to the main loop. It only sets the completion flags, and Wire waits for them
+ *       in a busy loop within the main loop, so a deferred handler would never run.
+ */
 void twi_master_handler(nrfx_twim_evt_t const *p_event, void *p_context)
 {
     switch (p_event->type)  // Check what type of TWI event ocurred.
@@ -27,6 +27,21 @@
 #include "nrf_drv_clock.h"
 #include "rf_host_device_api.h"
 
+static rfhdev_api_event_cb_t rfhdev_api_event_cb = NULL;
+
+static void rfhdev_api_sleep_postpone_cb(void)
+{
+    if (rfhdev_api_event_cb != NULL)
+    {
+        rfhdev_api_event_cb();
+    }
+}
+
+void rfhdev_api_event_cb_set(rfhdev_api_event_cb_t event_cb)
+{
+    rfhdev_api_event_cb = event_cb;
+}
+
 void rfhdev_api_init(void)
 {
     result_t result = RESULT_ERR;
@@ -35,7 +50,7 @@ void rfhdev_api_init(void)
     rfhdev_config.clock_hfclk_start_cb = nrfx_clock_hfclk_start;
     rfhdev_config.clock_hfclk_stop_cb = nrfx_clock_hfclk_stop;
     rfhdev_config.ppi_channel_alloc_cb = nrfx_ppi_channel_alloc;
-    rfhdev_config.sleep_postpone_cb = NULL;
+    rfhdev_config.sleep_postpone_cb = rfhdev_api_sleep_postpone_cb;
     rfhdev_config.millis_request_cb = millis;
 
     result = rfhdev_init( &rfhdev_config );
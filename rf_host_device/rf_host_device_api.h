@@ -33,7 +33,11 @@ extern "C" {
     #define RFGW_PIPE_ID_KEYSCANNER_LEFT RFGW_PIPE_ID_1
     #define RFGW_PIPE_ID_KEYSCANNER_RIGHT RFGW_PIPE_ID_2
 
+    /* Called from the RF interrupts when the gateway has work for rfgw_poll */
+    typedef void (*rfhdev_api_event_cb_t)(void);
+
     extern void rfhdev_api_init(void);
+    extern void rfhdev_api_event_cb_set(rfhdev_api_event_cb_t event_cb);
 
 #ifdef __cplusplus
 }
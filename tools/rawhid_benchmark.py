@@ -0,0 +1,74 @@
+import sys
+import time
+import hid
+
+# Measures the raw HID transmit throughput of the keyboard for a large Focus dump.
+#
+# Usage: python rawhid_benchmark.py <vid> <pid> <report_len> [command]
+#   vid, pid    The USB or BLE HID identifiers of the keyboard ( e.g. 0x35ef 0x0012 ).
+#   report_len  The raw HID report payload length, INPUT_REPORT_LEN_RAW and OUTPUT_REPORT_LEN_RAW of the firmware.
+#   command     The Focus command to dump, "help" by default. The larger the answer, the better the estimate.
+#
+# Requires the hidapi bindings ( pip install hidapi ).
+
+REPORT_ID_RAW = 0x05
+USAGE_PAGE_VENDOR = 0xFF00
+QUIET_TIMEOUT_MS = 1000
+
+def raw_interface_open(vid, pid):
+    for info in hid.enumerate(vid, pid):
+        if( info['usage_page'] == USAGE_PAGE_VENDOR ):
+            dev = hid.device()
+            dev.open_path(info['path'])
+            return dev
+
+    sys.exit( "No raw HID interface found." )
+
+def main(vid, pid, report_len, command):
+    dev = raw_interface_open(vid, pid)
+
+    # The command goes as a text report, padded with zeros
+    request = (command + "\n").encode()
+    dev.write( [REPORT_ID_RAW] + list(request.ljust(report_len, b'\0')) )
+
+    rx_bytes = 0
+    rx_bytes_first = 0
+    rx_reports = 0
+    t_first = None
+    t_last = None
+
+    # Read until the keyboard stops sending
+    while True:
+        report = dev.read(report_len + 1, QUIET_TIMEOUT_MS)
+        if( len(report) == 0 ):
+            break
+
+        t_last = time.perf_counter()
+        if( t_first is None ):
+            t_first = t_last
+
+        # The report ID is kept by some platforms only, the zero padding of the last report is not counted
+        payload = bytes(report[1:] if report[0] == REPORT_ID_RAW and len(report) > report_len else report)
+        rx_bytes += len(payload.rstrip(b'\0'))
+        rx_reports += 1
+        if( rx_reports == 1 ):
+            rx_bytes_first = rx_bytes
+
+    dev.close()
+
+    if( rx_reports < 2 ):
+        sys.exit( "Not enough reports received to measure the throughput." )
+
+    # The first report only starts the clock, so its bytes are not in the rate
+    elapsed = t_last - t_first
+    print( "Reports:    %d" % rx_reports )
+    print( "Bytes:      %d" % rx_bytes )
+    print( "Time:       %.3f s" % elapsed )
+    print( "Throughput: %.2f KB/s" % ((rx_bytes - rx_bytes_first) / elapsed / 1024) )
+
+if __name__ == "__main__":
+    vid = int(sys.argv[1], 0)
+    pid = int(sys.argv[2], 0)
+    report_len = int(sys.argv[3], 0)
+    command = sys.argv[4] if len(sys.argv) > 4 else "help"
+    main(vid, pid, report_len, command)